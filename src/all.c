@@ -20,6 +20,7 @@
 
 /* eval & search */
 #include "eval.c"
+#include "nnue.c"
 #include "hash.c"
 #include "ybwc.c"
 #include "search.c"
@@ -50,6 +51,9 @@
 #include "nboard.c"
 #include "xboard.c"
 
+/* library interface */
+#include "libedax.c"
+
 /* main */
 #include "main.c"
 
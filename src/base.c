@@ -641,6 +641,37 @@ void wthor_eval(const char *file, Search *search, unsigned long long histogram[1
 	return;
 }
 
+/**
+ * @brief Compare the quantized to the 16-bit evaluation on the positions of a wthor base.
+ *
+ * All the positions of the games, with at least a legal move, are compared.
+ *
+ * @param file Wthor game file.
+ * @param report Accuracy report.
+ */
+void wthor_eval_q8(const char *file, EvalQ8Report *report)
+{
+	WthorBase base;
+	WthorGame *wthor;
+	Board board;
+	Move move;
+	int i;
+
+	if (wthor_load(&base, file)) {
+		foreach_wthorgame(wthor, base) {
+			board_init(&board);
+			for (i = 0; i < 60 && wthor->x[i]; ++i) {
+				if (board_is_pass(&board)) board_pass(&board);
+				board_get_move_flip(&board, move_from_wthor(wthor->x[i]), &move);
+				if (!board_check_move(&board, &move)) break;
+				eval_q8_report_add(report, &board);
+				board_update(&board, &move);
+			}
+		}
+		wthor_free(&base);
+	}
+}
+
 /**
  * @brief Change players to "Edax (delorme)" and tourney to "Etudes"
  * in a wthor base.
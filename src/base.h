@@ -16,6 +16,7 @@
 
 /* structures */
 struct Search;
+struct EvalQ8Report;
 
 /**
  * struct WthorHeader
@@ -57,6 +58,7 @@ bool wthor_load(WthorBase*, const char*);
 bool wthor_save(WthorBase*, const char*);
 void wthor_test(const char*, struct Search*);
 void wthor_eval(const char*, struct Search*, unsigned long long histogram[129][65]);
+void wthor_eval_q8(const char*, struct EvalQ8Report*);
 void wthor_edaxify(const char*);
 
 #define foreach_wthorgame(wgame, wbase) \
@@ -2583,7 +2583,10 @@ void book_stats(Book *book)
 
 /**
  * @brief feed hash table from the opening book.
- * 
+ *
+ * The fed tables are marked as warm, so that the next cleanups keep them,
+ * as well as the entries of an image loaded before.
+ *
  * @param book Opening book.
  * @param board Position to start from.
  * @param search HashTables container.
@@ -2591,4 +2594,5 @@ void book_stats(Book *book)
 void book_feed_hash(const Book *book, Board *board, Search *search)
 {
 	board_feed_hash(board, book, search, true);
+	search->hash_table.warm = search->pv_table.warm = true;	// kept by search_cleanup(), as a loaded image
 }
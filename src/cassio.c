@@ -281,6 +281,8 @@ static int engine_open(Search *search, const Board *board, const int player, con
 
 	options.beta = beta;
 	BOUND(options.beta, options.alpha + 1, SCORE_MAX, "beta");
+	search->options.alpha = options.alpha;
+	search->options.beta = options.beta;
 
 	// other initializations
 	search->n_nodes = 0;
@@ -12,7 +12,7 @@
 #define EDAX_CONST_H
 
 /** maximal number of threads */
-#define MAX_THREADS 64
+#define MAX_THREADS 1024
 
 /** maximal number of moves */
 #define MAX_MOVE 33	// https://eukaryote.hateblo.jp/entry/2023/05/23/145945
@@ -67,6 +67,7 @@ enum {
 typedef enum Stop {
 	RUNNING = 0,
 	STOP_PARALLEL_SEARCH,
+	STOP_PARALLEL_CUTOFF,
 	STOP_PONDERING,
 	STOP_TIMEOUT,
 	STOP_ON_DEMAND,
@@ -86,10 +87,12 @@ typedef	unsigned char	NodeType;
 #define VERSION_STRING "4.5.4"
 #define EDAX_NAME "Edax 4.5.4"
 #define BOOK 0x424f4f4b
+#define HASH 0x48415348
 #define EDAX 0x45444158
 #define EVAL 0x4556414c
 #define XADE 0x58414445
 #define LAVE 0x4c415645
+#define NNUE 0x4e4e5545
 
 /**
  * Edax state.
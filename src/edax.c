@@ -42,6 +42,9 @@
  *   -hint [n]            ask edax to search the first bestmoves.
  *   -m|mode [n]          ask edax to automatically play (default = 3).
  *   -a|analyze [n]       retro-analyze the game.
+ *   -hash save <file>    save the hash tables into a file.
+ *   -hash load <file>    load the hash tables from a file.
+ *   -hashstats           display the hash tables occupancy & statistics.
  *   -?|help              show this message.
  *   -v|version           display the version number.
  *
@@ -209,6 +212,9 @@ void help_commands(void)
 		"  hint [n]            ask edax to search the first bestmoves.\n"
 		"  m|mode [n]          ask edax to automatically play (default = 3).\n"
 		"  a|analyze [n]       retro-analyze the game.\n"
+		"  hash save <file>    save the hash tables into a file.\n"
+		"  hash load <file>    load the hash tables from a file (keep them with\n  hash-lazy-clear on).\n"
+		"  hashstats           display the hash tables occupancy & statistics.\n"
 		"  ?|help              show this message.\n"
 		"  v|version           display the version number.\n");
 }
@@ -617,6 +623,27 @@ void ui_loop_edax(UI *ui)
 				if (name == NULL) name = "?";
 				puts(name); 
 
+			// hash table statistics
+			} else if (strcmp(cmd, "hashstats") == 0) {
+				search_report_hashtable(&play->search, stdout);
+
+			// hash table commands
+			} else if (strcmp(cmd, "hash") == 0) {
+				char hash_cmd[FILENAME_MAX + 1], hash_file[FILENAME_MAX + 1];
+
+				play_stop_pondering(play);
+				*hash_file = '\0';
+				parse_word(parse_word(param, hash_cmd, FILENAME_MAX), hash_file, FILENAME_MAX);
+				if (*hash_file == '\0') {
+					warn("Missing hash file: \"%s %s\"\n", cmd, param);
+				} else if (strcmp(hash_cmd, "save") == 0) {
+					search_save_hashtable(&play->search, hash_file);
+				} else if (strcmp(hash_cmd, "load") == 0) {
+					search_load_hashtable(&play->search, hash_file);
+				} else {
+					warn("Unknown hash command: \"%s %s\"\n", cmd, param);
+				}
+
 			// opening book commands
 			} else if (strcmp(cmd, "book") == 0 || strcmp(cmd, "b") == 0) {
 				char book_cmd[FILENAME_MAX + 1], *book_param;
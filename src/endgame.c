@@ -17,6 +17,7 @@
 #include "ybwc.h"
 
 #include <assert.h>
+#include <string.h>
 
 #if COUNT_LAST_FLIP == COUNT_LAST_FLIP_32
 	#include "count_last_flip_32.c"
@@ -113,7 +114,7 @@ int search_solve_0(const Search *search)
  * @param n_nodes Node counter.
  * @return The final min score, as a disc difference.
  */
-static int solve_2(unsigned long long player, unsigned long long opponent, int alpha, int x1, int x2, volatile unsigned long long *n_nodes)
+static int solve_2(unsigned long long player, unsigned long long opponent, int alpha, int x1, int x2, unsigned long long *n_nodes)
 {
 	unsigned long long flipped;
 	int score, bestscore, nodes;
@@ -179,7 +180,7 @@ static int solve_2(unsigned long long player, unsigned long long opponent, int a
  * @param n_nodes Node counter.
  * @return The final max score, as a disc difference.
  */
-static int solve_3(unsigned long long player, unsigned long long opponent, int alpha, int sort3, int x1, int x2, int x3, volatile unsigned long long *n_nodes)
+static int solve_3(unsigned long long player, unsigned long long opponent, int alpha, int sort3, int x1, int x2, int x3, unsigned long long *n_nodes)
 {
 	unsigned long long flipped, next_player, next_opponent;
 	int score, bestscore, pol, tmp;
@@ -361,19 +362,153 @@ static int search_solve_4(Search *search, int alpha)
 }
 #endif
 
+/** mask of the endgame cache index */
+#define ENDCACHE_MASK ((1 << ENDCACHE_SIZE) - 1)
+
 /**
- * @brief  Evaluate a position using a shallow NWS.
+ * @brief Allocate the endgame cache of a search.
  *
- * This function is used when there are few empty squares on the board. Here,
- * optimizations are in favour of speed instead of efficiency.
- * Move ordering is constricted to the hole parity and the type of squares.
- * No hashtable are used and anticipated cut-off is limited to stability cut-off.
+ * The endgame cache is a small direct-mapped table of exact scores, owned by
+ * a single search and so by a single thread. Unlike the main hashtable, it is
+ * read and written without any lock, and, as an endgame score never gets
+ * stale, it is never cleared.
+ *
+ * @param search Search.
+ */
+void endcache_init(Search *search)
+{
+	const size_t size = sizeof (EndCacheEntry) << ENDCACHE_SIZE;
+
+	search->end_cache = (EndCacheEntry *) mm_malloc(size);
+	if (search->end_cache == NULL) {
+		fatal_error("Cannot allocate the endgame cache\n");
+	}
+	memset(search->end_cache, 0, size);	// no position has an empty board
+}
+
+/**
+ * @brief Free the endgame cache of a search.
+ *
+ * @param search Search.
+ */
+void endcache_free(Search *search)
+{
+	if (search->end_cache) mm_free(search->end_cache);
+	search->end_cache = NULL;
+}
+
+/**
+ * @brief Probe the endgame cache for a cutoff.
+ *
+ * @param entry Cache entry of the board.
+ * @param board Board (solid normalized).
+ * @param ofssolid Score offset of the solid normalization.
+ * @param alpha Alpha bound.
+ * @param score Score to return in case of a cutoff is found.
+ * @param move Best move found, or NOMOVE.
+ * @return 'true' if a cutoff is found, false otherwise.
+ */
+static inline bool endcache_get(const EndCacheEntry *entry, const Board *board, const int ofssolid, const int alpha, int *score, unsigned char *move)
+{
+	*move = NOMOVE;
+	if (entry->player == board->player && entry->opponent == board->opponent) {
+		CUTOFF_STATS(++statistics.n_endcache_try;)
+		if (entry->lower - ofssolid > alpha) {
+			CUTOFF_STATS(++statistics.n_endcache_high_cutoff;)
+			*score = entry->lower - ofssolid;
+			return true;
+		}
+		if (entry->upper - ofssolid <= alpha) {
+			CUTOFF_STATS(++statistics.n_endcache_low_cutoff;)
+			*score = entry->upper - ofssolid;
+			return true;
+		}
+		*move = entry->move;
+	}
+	return false;
+}
+
+/**
+ * @brief Store a null window search result into the endgame cache.
+ *
+ * The entry of another position is always replaced.
+ *
+ * @param entry Cache entry of the board.
+ * @param board Board (solid normalized).
+ * @param alpha Alpha bound (solid normalized).
+ * @param score Best score (solid normalized).
+ * @param move Best move, or NOMOVE to keep the cached one.
+ */
+static inline void endcache_store(EndCacheEntry *entry, const Board *board, const int alpha, const int score, const int move)
+{
+	if (entry->player != board->player || entry->opponent != board->opponent) {
+		entry->player = board->player;
+		entry->opponent = board->opponent;
+		entry->lower = SCORE_MIN;
+		entry->upper = SCORE_MAX;
+		entry->move = NOMOVE;
+	}
+	if (score > alpha) entry->lower = score;
+	else entry->upper = score;
+	if (move != NOMOVE) entry->move = move;
+}
+
+/**
+ * @brief Stability cutoff, and solid normalization of the board.
+ *
+ * Opponent's discs on full lines will never be flipped again. Giving them to
+ * the player makes transpositions which only differ by them share a hash
+ * entry, whose score is then ofssolid greater than the real one.
+ *
+ * @param search Search.
+ * @param alpha Alpha bound.
+ * @param score Score to return in case of a cutoff is found.
+ * @param hashboard Board to use as a hash key.
+ * @param ofssolid Score offset of hashboard.
+ * @return 'true' if a cutoff is found, false otherwise.
+ */
+static bool search_SC_NWS_solid(Search *search, const int alpha, int *score, Board *hashboard, int *ofssolid)
+{
+	unsigned long long full[5], solid_opp;
+
+	*hashboard = search->board;
+	*ofssolid = 0;
+	if (USE_SC && alpha >= NWS_STABILITY_THRESHOLD[search->eval.n_empties]) {	// (7%)
+		CUTOFF_STATS(++statistics.n_stability_try;)
+		*score = SCORE_MAX - 2 * get_stability_fulls(search->board.opponent, search->board.player, full);
+		if (*score <= alpha) {	// (3%)
+			CUTOFF_STATS(++statistics.n_stability_low_cutoff;)
+			return true;
+		}
+
+		// Improvement of Serch by Reducing Redundant Information in a Position of Othello
+		// Hidekazu Matsuo, Shuji Narazaki
+		// http://id.nii.ac.jp/1001/00156359/
+		if (search->eval.n_empties <= MASK_SOLID_DEPTH) {	// (99%)
+			solid_opp = full[4] & hashboard->opponent;	// full[4] = all full
+#ifndef POPCOUNT
+			if (solid_opp)	// (72%)
+#endif
+			{
+				hashboard->player ^= solid_opp;	// normalize solid to player
+				hashboard->opponent ^= solid_opp;
+				*ofssolid = bit_count(solid_opp) * 2;	// hash score is ofssolid grater than real
+			}
+		}
+	}
+	return false;
+}
+
+static int search_shallow(Search*, const int, bool);
+
+/**
+ * @brief  Evaluate the moves of a position using a shallow NWS.
  *
  * @param search Search. (breaks board and parity; caller has a copy)
  * @param alpha Alpha bound.
  * @return The final score, as a disc difference.
  */
-static int search_shallow(Search *search, const int alpha, bool pass1)
+static int search_shallow_moves(Search *search, const int alpha, bool pass1)
 {
 	unsigned long long moves, prioritymoves;
 	int x, prev, score, bestscore;
@@ -381,15 +516,6 @@ static int search_shallow(Search *search, const int alpha, bool pass1)
 	V2DI board0;
 	unsigned int parity0;
 
-	assert(SCORE_MIN <= alpha && alpha <= SCORE_MAX);
-	assert(0 <= search->eval.n_empties && search->eval.n_empties <= DEPTH_TO_SHALLOW_SEARCH);
-
-	SEARCH_STATS(++statistics.n_NWS_shallow);
-	SEARCH_UPDATE_INTERNAL_NODES(search->n_nodes);
-
-	// stability cutoff (try 8%, cut 7%)
-	if (search_SC_NWS(search, alpha, &score)) return score;
-
 	board0.board = search->board;
 	moves = vboard_get_moves(board0);
 	if (moves == 0) {	// pass (2%)
@@ -466,6 +592,127 @@ static int search_shallow(Search *search, const int alpha, bool pass1)
 	return bestscore;	// (33%)
 }
 
+/**
+ * @brief  Evaluate a position using a shallow NWS.
+ *
+ * This function is used when there are few empty squares on the board. Here,
+ * optimizations are in favour of speed instead of efficiency.
+ * Move ordering is constricted to the hole parity and the type of squares.
+ * No hashtable are used and anticipated cut-off is limited to stability cut-off,
+ * and, from ENDCACHE_MIN_DEPTH empties, to the thread-local endgame cache.
+ *
+ * @param search Search. (breaks board and parity; caller has a copy)
+ * @param alpha Alpha bound.
+ * @return The final score, as a disc difference.
+ */
+static int search_shallow(Search *search, const int alpha, bool pass1)
+{
+	int score, ofssolid;
+	Board hashboard;
+	EndCacheEntry *entry;
+	unsigned char move;
+
+	assert(SCORE_MIN <= alpha && alpha <= SCORE_MAX);
+	assert(0 <= search->eval.n_empties && search->eval.n_empties <= DEPTH_TO_SHALLOW_SEARCH);
+
+	SEARCH_STATS(++statistics.n_NWS_shallow);
+	SEARCH_UPDATE_INTERNAL_NODES(search->n_nodes);
+
+	if (search->eval.n_empties < ENDCACHE_MIN_DEPTH) {
+		// stability cutoff (try 8%, cut 7%)
+		if (search_SC_NWS(search, alpha, &score)) return score;
+		return search_shallow_moves(search, alpha, pass1);
+	}
+
+	// stability cutoff & endgame cache cutoff
+	if (search_SC_NWS_solid(search, alpha, &score, &hashboard, &ofssolid)) return score;
+	entry = search->end_cache + (board_get_hash_code(&hashboard) & ENDCACHE_MASK);
+	if (endcache_get(entry, &hashboard, ofssolid, alpha, &score, &move)) return score;
+
+	score = search_shallow_moves(search, alpha, pass1);
+	endcache_store(entry, &hashboard, alpha + ofssolid, score + ofssolid, NOMOVE);
+	return score;
+}
+
+/**
+ * @brief Search the moves of an endgame node in parallel.
+ *
+ * The node is split like a midgame one, but is flagged as an endgame node:
+ * as the evaluation features are not updated by the endgame search, the
+ * slaves only update the board, the empty squares and the parity, and go on
+ * with NWS_endgame().
+ * As most endgame nodes are cut by their first move, or find no thread to
+ * help them, the moves are first searched sequentially, and the shared node
+ * is only set up after the first move, once a helper is available (see
+ * node_has_helper()).
+ *
+ * @param search Search.
+ * @param alpha Alpha bound.
+ * @param movelist List of moves.
+ * @param bestmove Output: best move.
+ * @param parent Parent node.
+ * @return The best score, as a disc difference.
+ */
+static int NWS_endgame_split(Search *search, const int alpha, MoveList *movelist, unsigned char *bestmove, Node *parent)
+{
+	Node node;
+	Move *move;
+	V2DI board0;
+	const unsigned int parity0 = search->eval.parity;
+	int n_moves_done = 0, bestscore = -SCORE_INF;
+
+	board0.board = search->board;
+	movelist_sort(movelist);
+	*bestmove = NOMOVE;
+
+	// sequential search, until a split is worth it
+	for (move = movelist_first(movelist); move && !search->stop; move = move_next(move), ++n_moves_done) {
+		if (n_moves_done && movelist->n_moves - n_moves_done >= SPLIT_MIN_MOVES_TODO && node_has_helper(parent, search)) break;
+		search->eval.parity = parity0 ^ QUADRANT_ID[move->x];
+		empty_remove(search->empties, move->x);
+		vboard_update(&search->board, board0, move);
+		--search->eval.n_empties;
+		move->score = -NWS_endgame(search, ~alpha, parent);
+		++search->eval.n_empties;
+		empty_restore(search->empties, move->x);
+		search->board = board0.board;
+		search->eval.parity = parity0;
+		if (!search->stop && move->score > bestscore) {
+			bestscore = move->score;
+			*bestmove = move->x;
+			if (bestscore > alpha) return bestscore;
+		}
+	}
+	if (move == NULL || search->stop) return bestscore;
+
+	// parallel search of the remaining moves
+	node_init(&node, search, alpha, alpha + 1, search->eval.n_empties, movelist->n_moves - n_moves_done, parent);
+	node.endgame = true;
+	node.bestscore = bestscore;
+	node.bestmove = *bestmove;
+	node.n_moves_done = n_moves_done;
+	node.move = move;
+	for (; move; move = node_next_move(&node)) {
+		if (!node_split(&node, move)) {
+			search->eval.parity = parity0 ^ QUADRANT_ID[move->x];
+			empty_remove(search->empties, move->x);
+			vboard_update(&search->board, board0, move);
+			--search->eval.n_empties;
+			move->score = -NWS_endgame(search, ~alpha, &node);
+			++search->eval.n_empties;
+			empty_restore(search->empties, move->x);
+			search->board = board0.board;
+			search->eval.parity = parity0;
+			node_update(&node, move);
+		}
+	}
+	node_wait_slaves(&node);
+	node_free(&node);
+
+	*bestmove = node.bestmove;
+	return node.bestscore;
+}
+
 /**
  * @brief Evaluate an endgame position with a Null Window Search algorithm.
  *
@@ -476,20 +723,21 @@ static int search_shallow(Search *search, const int alpha, bool pass1)
  *
  * @param search Search.
  * @param alpha Alpha bound.
+ * @param parent Parent node.
  * @return The final score, as a disc difference.
  */
-int NWS_endgame(Search *search, const int alpha)
+int NWS_endgame(Search *search, const int alpha, Node *parent)
 {
 	int score, ofssolid, bestscore;
-	unsigned long long hash_code, solid_opp;
+	unsigned long long hash_code;
 	// const int beta = alpha + 1;
 	HashStoreData hash_data;
 	Move *move;
 	long long nodes_org;
 	V2DI board0;
 	Board hashboard;
+	EndCacheEntry *entry;
 	unsigned int parity0;
-	unsigned long long full[5];
 	MoveList movelist;
 
 	assert(bit_count(~(search->board.player|search->board.opponent)) < DEPTH_MIDGAME_TO_ENDGAME);
@@ -501,40 +749,27 @@ int NWS_endgame(Search *search, const int alpha)
 	SEARCH_UPDATE_INTERNAL_NODES(search->n_nodes);
 
 	// stability cutoff
-	hashboard = board0.board = search->board;
-	ofssolid = 0;
-	if (USE_SC && alpha >= NWS_STABILITY_THRESHOLD[search->eval.n_empties]) {	// (7%)
-		CUTOFF_STATS(++statistics.n_stability_try;)
-		score = SCORE_MAX - 2 * get_stability_fulls(search->board.opponent, search->board.player, full);
-		if (score <= alpha) {	// (3%)
-			CUTOFF_STATS(++statistics.n_stability_low_cutoff;)
-			return score;
-		}
-
-		// Improvement of Serch by Reducing Redundant Information in a Position of Othello
-		// Hidekazu Matsuo, Shuji Narazaki
-		// http://id.nii.ac.jp/1001/00156359/
-		if (search->eval.n_empties <= MASK_SOLID_DEPTH) {	// (99%)
-			solid_opp = full[4] & hashboard.opponent;	// full[4] = all full
-#ifndef POPCOUNT
-			if (solid_opp)	// (72%)
-#endif
-			{
-				hashboard.player ^= solid_opp;	// normalize solid to player
-				hashboard.opponent ^= solid_opp;
-				ofssolid = bit_count(solid_opp) * 2;	// hash score is ofssolid grater than real
-			}
-		}
-	}
+	board0.board = search->board;
+	if (search_SC_NWS_solid(search, alpha, &score, &hashboard, &ofssolid)) return score;
 
 	hash_code = board_get_hash_code(&hashboard);
-	hash_prefetch(&search->hash_table, hash_code);
+	if (search->eval.n_empties <= ENDCACHE_MAX_DEPTH)	// small enough for the endgame cache
+		entry = search->end_cache + (hash_code & ENDCACHE_MASK);
+	else {
+		entry = NULL;
+		hash_prefetch(&search->hash_table, hash_code);
+	}
 
 	search_get_movelist(search, &movelist);
 
 	if (movelist.n_moves > 1) {	// (96%)
 		// transposition cutoff
-		if (hash_get(&search->hash_table, &hashboard, hash_code, &hash_data.data)) {	// (6%)
+		if (entry) {
+			if (endcache_get(entry, &hashboard, ofssolid, alpha, &score, &hash_data.data.move[0]))
+				return score;
+			hash_data.data.move[1] = NOMOVE;
+
+		} else if (hash_get(&search->hash_table, &hashboard, hash_code, &hash_data.data)) {	// (6%)
 			hash_data.data.lower -= ofssolid;
 			hash_data.data.upper -= ofssolid;
 			if (search_TC_NWS(&hash_data.data, search->eval.n_empties, NO_SELECTIVITY, alpha, &score))	// (6%)
@@ -545,55 +780,64 @@ int NWS_endgame(Search *search, const int alpha)
 
 		movelist_evaluate_fast(&movelist, search, &hash_data.data);
 
-		nodes_org = search->n_nodes;
-		parity0 = search->eval.parity;
-		bestscore = -SCORE_INF;
-		// loop over all moves
-		move = &movelist.move[0];
-		if (--search->eval.n_empties <= DEPTH_TO_SHALLOW_SEARCH)	// for next move (44%)
-			while ((move = move_next_best(move))) {	// (72%)
-				search->eval.parity = parity0 ^ QUADRANT_ID[move->x];
-				search->empties[search->empties[move->x].previous].next = search->empties[move->x].next;	// remove - maintain single link only
-				vboard_update(&search->board, board0, move);
-				score = -search_shallow(search, ~alpha, false);
-				search->empties[search->empties[move->x].previous].next = move->x;	// restore
-				search->board = board0.board;
-
-				if (score > bestscore) {	// (63%)
-					bestscore = score;
-					hash_data.data.move[0] = move->x;
-					if (bestscore > alpha) break;	// (48%)
+		nodes_org = search_count_nodes(search);
+		if (search->allow_node_splitting && search->options.parallel_mode != PARALLEL_LAZY
+		 && search->eval.n_empties >= SPLIT_MIN_ENDGAME_DEPTH) {	// parallel search
+			bestscore = NWS_endgame_split(search, alpha, &movelist, &hash_data.data.move[0], parent);
+		} else {
+			parity0 = search->eval.parity;
+			bestscore = -SCORE_INF;
+			// loop over all moves
+			move = &movelist.move[0];
+			if (--search->eval.n_empties <= DEPTH_TO_SHALLOW_SEARCH)	// for next move (44%)
+				while ((move = move_next_best(move))) {	// (72%)
+					search->eval.parity = parity0 ^ QUADRANT_ID[move->x];
+					search->empties[search->empties[move->x].previous].next = search->empties[move->x].next;	// remove - maintain single link only
+					vboard_update(&search->board, board0, move);
+					score = -search_shallow(search, ~alpha, false);
+					search->empties[search->empties[move->x].previous].next = move->x;	// restore
+					search->board = board0.board;
+
+					if (score > bestscore) {	// (63%)
+						bestscore = score;
+						hash_data.data.move[0] = move->x;
+						if (bestscore > alpha) break;	// (48%)
+					}
 				}
-			}
-		else
-			while ((move = move_next_best(move))) {	// (76%)
-				search->eval.parity = parity0 ^ QUADRANT_ID[move->x];
-				empty_remove(search->empties, move->x);
-				vboard_update(&search->board, board0, move);
-				score = -NWS_endgame(search, ~alpha);
-				empty_restore(search->empties, move->x);
-				search->board = board0.board;
-
-				if (score > bestscore) {	// (63%)
-					bestscore = score;
-					hash_data.data.move[0] = move->x;
-					if (bestscore > alpha) break;	// (39%)
+			else
+				while ((move = move_next_best(move))) {	// (76%)
+					search->eval.parity = parity0 ^ QUADRANT_ID[move->x];
+					empty_remove(search->empties, move->x);
+					vboard_update(&search->board, board0, move);
+					score = -NWS_endgame(search, ~alpha, parent);
+					empty_restore(search->empties, move->x);
+					search->board = board0.board;
+
+					if (score > bestscore) {	// (63%)
+						bestscore = score;
+						hash_data.data.move[0] = move->x;
+						if (bestscore > alpha) break;	// (39%)
+					}
 				}
-			}
-		++search->eval.n_empties;
-		search->eval.parity = parity0;
+			++search->eval.n_empties;
+			search->eval.parity = parity0;
+		}
 
 		if (search->stop)	// (1%)
 			return alpha;
 
-		hash_data.data.wl.c.depth = search->eval.n_empties;
-		hash_data.data.wl.c.selectivity = NO_SELECTIVITY;
-		hash_data.data.wl.c.cost = last_bit(search->n_nodes - nodes_org);
-		// hash_data.data.move[0] = bestmove;
-		hash_data.alpha = alpha + ofssolid;
-		hash_data.beta = alpha + ofssolid + 1;
-		hash_data.score = bestscore + ofssolid;
-		hash_store(&search->hash_table, &hashboard, hash_code, &hash_data);
+		if (entry)
+			endcache_store(entry, &hashboard, alpha + ofssolid, bestscore + ofssolid, hash_data.data.move[0]);
+		else {
+			hash_data.data.wl.c.depth = search->eval.n_empties;
+			hash_data.data.wl.c.selectivity = NO_SELECTIVITY;
+			hash_data.data.wl.c.cost = last_bit(search_count_nodes(search) - nodes_org);
+			// hash_data.data.move[0] = bestmove;
+			hash_data.alpha = alpha + ofssolid;
+			hash_data.beta = alpha + ofssolid + 1;
+			hash_data.score = bestscore + ofssolid;
+			hash_store(&search->hash_table, &hashboard, hash_code, &hash_data);
+		}
 
 	// special cases
 	} else if (movelist.n_moves == 1) {	// (3%)
@@ -604,7 +848,7 @@ int NWS_endgame(Search *search, const int alpha)
 		vboard_update(&search->board, board0, move);
 		if (--search->eval.n_empties <= DEPTH_TO_SHALLOW_SEARCH)	// (56%)
 			bestscore = -search_shallow(search, ~alpha, false);
-		else	bestscore = -NWS_endgame(search, ~alpha);
+		else	bestscore = -NWS_endgame(search, ~alpha, parent);
 		++search->eval.n_empties;
 		empty_restore(search->empties, move->x);
 		search->eval.parity = parity0;
@@ -613,7 +857,7 @@ int NWS_endgame(Search *search, const int alpha)
 	} else {	// (1%)
 		if (can_move(search->board.opponent, search->board.player)) { // pass
 			search_pass(search);
-			bestscore = -NWS_endgame(search, ~alpha);
+			bestscore = -NWS_endgame(search, ~alpha, parent);
 			search_pass(search);
 		} else  { // game over
 			bestscore = search_solve(search);
@@ -627,6 +871,6 @@ int NWS_endgame(Search *search, const int alpha)
 			++statistics.n_good_square[search->eval.n_empties][SQUARE_TYPE[bestscore]];
 	}
  	assert(SCORE_MIN <= bestscore && bestscore <= SCORE_MAX);
- 	assert((bestscore & 1) == 0);
+ 	assert((bestscore & 1) == 0 || search->stop);
 	return bestscore;
 }
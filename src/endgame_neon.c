@@ -78,7 +78,7 @@ static int board_solve_neon(uint64x1_t P, int n_empties)
  * @param empties Packed empty square coordinates.
  * @return The final min score, as a disc difference.
  */
-static int solve_2(uint64x2_t OP, int alpha, volatile unsigned long long *n_nodes, uint8x8_t empties)
+static int solve_2(uint64x2_t OP, int alpha, unsigned long long *n_nodes, uint8x8_t empties)
 {
 	uint64x2_t flipped;
 	int score, bestscore, nodes;
@@ -145,7 +145,7 @@ static int solve_2(uint64x2_t OP, int alpha, volatile unsigned long long *n_node
  * @param empties Packed empty square coordinates.
  * @return The final max score, as a disc difference.
  */
-static int solve_3(uint64x2_t OP, int alpha, volatile unsigned long long *n_nodes, uint8x8_t empties)
+static int solve_3(uint64x2_t OP, int alpha, unsigned long long *n_nodes, uint8x8_t empties)
 {
 	uint64x2_t flipped;
 	int score, bestscore, x, pol;
@@ -62,7 +62,7 @@ static inline __m128i vectorcall board_flip_next(__m128i OP, int x, __m128i flip
  * @param empties Packed empty square coordinates.
  * @return The final min score, as a disc difference.
  */
-static int vectorcall solve_2(__m128i OP, int alpha, volatile unsigned long long *n_nodes, __m128i empties)
+static int vectorcall solve_2(__m128i OP, int alpha, unsigned long long *n_nodes, __m128i empties)
 {
 	__m128i flipped;
 	int score, bestscore, nodes;
@@ -128,7 +128,7 @@ static int vectorcall solve_2(__m128i OP, int alpha, volatile unsigned long long
  * @param empties Packed empty square coordinates.
  * @return The final max score, as a disc difference.
  */
-static int vectorcall solve_3(__m128i OP, int alpha, volatile unsigned long long *n_nodes, __m128i empties)
+static int vectorcall solve_3(__m128i OP, int alpha, unsigned long long *n_nodes, __m128i empties)
 {
 	__m128i flipped;
 	int score, bestscore, x, pol;
@@ -13,12 +13,19 @@
 
 #include "bit.h"
 #include "board.h"
+#include "const.h"
 #include "options.h"
 #include "move.h"
+#include "settings.h"
 #include "util.h"
 
 #include <stdlib.h>
 #include <assert.h>
+#include <limits.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
 
 #if !defined(VECTOR_EVAL_UPDATE) && !defined(hasSSE2) && !defined(__ARM_NEON)
 
@@ -477,6 +484,35 @@ static int EVAL_LOADED = 0;
 /** eval weights */
 Eval_weight (*EVAL_WEIGHT)[EVAL_N_PLY - 2];	// for 2..53
 
+/** evaluation by the neural network */
+bool EVAL_NNUE = false;
+
+/** quantized eval weights (with EVAL_Q8) */
+Eval_weight_q8 (*EVAL_WEIGHT_Q8)[EVAL_N_PLY - 2];
+
+/** header of the cached image of the unpacked weights */
+typedef struct EvalImageHeader {
+	unsigned int magic;          /**< EVIM, in the native byte order */
+	unsigned int weight_size;    /**< size of the weights of a ply */
+	unsigned int n_ply;          /**< number of plies */
+	unsigned int version[3];     /**< version, release & build of the weights */
+	unsigned int source_size;    /**< size of the evaluation file */
+	unsigned int source_crc;     /**< crc32c of the evaluation file */
+	unsigned int crc;            /**< crc32c of the header above */
+} EvalImageHeader;
+
+/** image magic number */
+#define EVIM 0x4556494d
+
+/** offset of the weights in the image (page aligned) */
+enum { EVAL_IMAGE_OFFSET = 4096 };
+
+/** mapped image of the weights */
+static struct {
+	void *data;                  /**< image (or NULL if the weights are unpacked in memory) */
+	size_t mapped;               /**< size of the memory mapping */
+} EVAL_IMAGE;
+
 /** opponent feature */
 static unsigned short *OPPONENT_FEATURE;
 
@@ -553,16 +589,15 @@ static int set_eval_packing(short *pe, int *T, const int *kd, int l, int k, int
 }
 
 /**
- * @brief Load the evaluation function features' weights.
+ * @brief Unpack the evaluation function features' weights.
  *
- * The weights are stored in a global variable, because, once loaded from the
- * file, they stay constant during the lifetime of the program. As loading
- * the weights is time & resource consuming, a counter variable check that
- * the weights are effectively loaded only once.
+ * Read the packed weights of the evaluation file, and unpack them for all the
+ * symetric & opponent features.
  *
  * @param file File name of the evaluation function data.
+ * @param v Output: version, release & build of the weights.
  */
-void eval_open(const char* file)
+static void eval_unpack(const char* file, unsigned int v[3])
 {
 	unsigned int edax_header, eval_header;
 	unsigned int version, release, build;
@@ -580,23 +615,12 @@ void eval_open(const char* file)
 	static const int kd_C10[] = { 19683, 6561, 2187, 729, 81, 243, 27, 9, 3, 1 };
 	static const int kd_C9[] = { 1, 9, 3, 81, 27, 243, 2187, 729, 6561 };
 
-	if (EVAL_LOADED++) return;
-
-	// the following is assumed:
-	//	-(unsigned) int are 32 bits
-	if (sizeof (int) != 4) fatal_error("int size is not compatible with Edax.\n");
-	//	-(unsigned) short are 16 bits
-	if (sizeof (short) != 2) fatal_error("short size is not compatible with Edax.\n");
-
 	// create unpacking tables
-	OPPONENT_FEATURE = (unsigned short *) malloc(59049 * sizeof(unsigned short));	// 3^10
 	P = (SymetryPacking (*)[2]) malloc(2 * sizeof(*P));
 	T = (int *) malloc(2 * 59049 * sizeof(*T));
-	if ((OPPONENT_FEATURE == NULL) || (P == NULL) || (T == NULL))
+	if ((P == NULL) || (T == NULL))
 		fatal_error("Cannot allocate temporary table variable.\n");
 
-	set_opponent_feature(OPPONENT_FEATURE, 0, 10);
-
 	set_eval_packing((*P)[0].EVAL_S8, T, kd_S10 + 2, 0, 0, 0, 8);	/* 8 squares : 6561 -> 3321 */
 	for (j = 0; j < 6561; ++j)
 		(*P)[1].EVAL_S8[j] = (*P)[0].EVAL_S8[OPPONENT_FEATURE[j + 26244]];	// 1100000000(3)
@@ -701,16 +725,269 @@ void eval_open(const char* file)
 	free(w);
 	free(P);
 
+	v[0] = version; v[1] = release; v[2] = build;
+}
+
+/**
+ * @brief Checksum of the evaluation file.
+ *
+ * @param file File name of the evaluation function data.
+ * @param size Output: size of the file.
+ * @return crc32c of the file content.
+ */
+static unsigned int eval_file_crc(const char *file, unsigned int *size)
+{
+	unsigned long long buffer[4096];
+	unsigned int crc = 0;
+	size_t n, i;
+	FILE *f;
+
+	*size = 0;
+	f = fopen(file, "rb");
+	if (f == NULL) return 0;
+	while ((n = fread(buffer, 1, sizeof (buffer), f)) > 0) {
+		for (i = 0; i < n / 8; ++i) crc = crc32c_u64(crc, buffer[i]);
+		for (i = n & ~(size_t) 7; i < n; ++i) crc = crc32c_u8(crc, ((unsigned char *) buffer)[i]);
+		*size += n;
+	}
+	fclose(f);
+
+	return crc;
+}
+
+/**
+ * @brief Checksum of an image header.
+ *
+ * @param header Image header.
+ * @return crc32c of the header, but its crc field.
+ */
+static unsigned int eval_image_header_crc(const EvalImageHeader *header)
+{
+	const unsigned int *x = (const unsigned int *) header;
+	unsigned int crc = 0;
+	int i;
+
+	for (i = 0; i < (int) (offsetof(EvalImageHeader, crc) / sizeof (int)); ++i) crc = crc32c_u64(crc, x[i]);
+
+	return crc;
+}
+
+/**
+ * @brief Map the cached image of the unpacked weights.
+ *
+ * The image is used only if its header is valid and matches the current
+ * evaluation file, layout & byte order.
+ *
+ * @param file File name of the evaluation function data.
+ * @param image_file File name of the image.
+ * @param v Output: version, release & build of the weights.
+ * @return true if the image is mapped.
+ */
+static bool eval_map_image(const char *file, const char *image_file, unsigned int v[3])
+{
+	const EvalImageHeader *header;
+	unsigned int source_size, source_crc;
+	size_t size;
+
+	EVAL_IMAGE.data = file_map(image_file, &size, &EVAL_IMAGE.mapped);
+	if (EVAL_IMAGE.data == NULL) return false;
+
+	header = (const EvalImageHeader *) EVAL_IMAGE.data;
+	source_crc = eval_file_crc(file, &source_size);
+	if (size == EVAL_IMAGE_OFFSET + sizeof (*EVAL_WEIGHT)
+	 && header->magic == EVIM && header->crc == eval_image_header_crc(header)
+	 && header->weight_size == sizeof (Eval_weight) && header->n_ply == EVAL_N_PLY - 2
+	 && header->source_size == source_size && header->source_crc == source_crc) {
+		EVAL_WEIGHT = (Eval_weight(*)[EVAL_N_PLY - 2]) ((char *) EVAL_IMAGE.data + EVAL_IMAGE_OFFSET);
+		v[0] = header->version[0]; v[1] = header->version[1]; v[2] = header->version[2];
+		info("<Evaluation function weights mapped from %s>\n", image_file);
+		return true;
+	}
+
+	info("<Evaluation weight image %s is out of date>\n", image_file);
+	large_free(EVAL_IMAGE.data, EVAL_IMAGE.mapped);
+	EVAL_IMAGE.data = NULL;
+	return false;
+}
+
+/**
+ * @brief Save the unpacked weights into an image.
+ *
+ * The image is written into a temporary file first, then renamed, so that
+ * another process never maps a partially written image.
+ *
+ * @param file File name of the evaluation function data.
+ * @param image_file File name of the image.
+ * @param v Version, release & build of the weights.
+ */
+static void eval_save_image(const char *file, const char *image_file, const unsigned int v[3])
+{
+	char header[EVAL_IMAGE_OFFSET];
+	EvalImageHeader *h = (EvalImageHeader *) header;
+	char tmp_file[FILENAME_MAX];
+	FILE *f;
+	bool ok;
+
+	memset(header, 0, sizeof (header));
+	h->magic = EVIM;
+	h->weight_size = sizeof (Eval_weight);
+	h->n_ply = EVAL_N_PLY - 2;
+	h->version[0] = v[0]; h->version[1] = v[1]; h->version[2] = v[2];
+	h->source_crc = eval_file_crc(file, &h->source_size);
+	h->crc = eval_image_header_crc(h);
+
+	snprintf(tmp_file, sizeof (tmp_file), "%s.tmp", image_file);
+	f = fopen(tmp_file, "wb");
+	if (f == NULL) {
+		warn("Cannot write the evaluation weight image %s\n", tmp_file);
+		return;
+	}
+	ok = (fwrite(header, sizeof (header), 1, f) == 1 && fwrite(*EVAL_WEIGHT, sizeof (*EVAL_WEIGHT), 1, f) == 1);
+	ok = (fclose(f) == 0) && ok;
+#ifdef _WIN32
+	if (ok) remove(image_file);
+#endif
+	if (!ok || rename(tmp_file, image_file) != 0) {
+		warn("Cannot write the evaluation weight image %s\n", image_file);
+		remove(tmp_file);
+	} else info("<Evaluation weight image %s saved>\n", image_file);
+}
+
+/**
+ * @brief Free the 16-bit weights, either mapped or unpacked in memory.
+ */
+static void eval_weight_free(void)
+{
+	if (EVAL_IMAGE.data) large_free(EVAL_IMAGE.data, EVAL_IMAGE.mapped);
+	else free(EVAL_WEIGHT);
+	EVAL_IMAGE.data = NULL;
+	EVAL_WEIGHT = NULL;
+}
+
+/**
+ * @brief Quantize a table of weights to 8 bits.
+ *
+ * The scale is the smallest integer mapping the largest absolute weight
+ * into [-127, 127]; the weights are rounded to the nearest multiple of it.
+ *
+ * @param w 16-bit weights.
+ * @param n Number of weights.
+ * @param q Output: 8-bit weights.
+ * @return The scale of the table.
+ */
+static short eval_quantize_table(const short *w, const int n, signed char *q)
+{
+	int i, m, scale;
+
+	for (m = i = 0; i < n; ++i) m = MAX(m, abs(w[i]));
+	scale = MAX(1, (m + 126) / 127);
+	for (i = 0; i < n; ++i) {
+		if (w[i] >= 0) q[i] = (signed char) ((w[i] + scale / 2) / scale);
+		else q[i] = (signed char) -((scale / 2 - w[i]) / scale);
+	}
+
+	return (short) scale;
+}
+
+/**
+ * @brief Quantize the weights of a ply.
+ *
+ * @param w 16-bit weights.
+ * @param q Output: quantized weights.
+ */
+static void eval_quantize(const Eval_weight *w, Eval_weight_q8 *q)
+{
+	q->S0 = w->S0;
+	q->scale[0] = eval_quantize_table(w->C9, 19683, q->C9);
+	q->scale[1] = eval_quantize_table(w->C10, 59049, q->C10);
+	q->scale[2] = eval_quantize_table(w->S100, 59049, q->S100);
+	q->scale[3] = eval_quantize_table(w->S101, 59049, q->S101);
+	q->scale[4] = eval_quantize_table(w->S8x4, 6561 * 4, q->S8x4);
+	q->scale[5] = eval_quantize_table(w->S7654, 2187 + 729 + 243 + 81, q->S7654);
+}
+
+/**
+ * @brief Quantize the weights of all the plies.
+ *
+ * @return The quantized weights.
+ */
+static Eval_weight_q8 (*eval_quantize_weights(void))[EVAL_N_PLY - 2]
+{
+	Eval_weight_q8 (*q)[EVAL_N_PLY - 2];
+	int ply;
+
+	q = (Eval_weight_q8 (*)[EVAL_N_PLY - 2]) malloc(sizeof (*q));
+	if (q == NULL) fatal_error("Cannot allocate quantized evaluation weights.\n");
+	for (ply = 0; ply < EVAL_N_PLY - 2; ++ply)
+		eval_quantize(&(*EVAL_WEIGHT)[ply], &(*q)[ply]);
+
+	return q;
+}
+
+#if EVAL_Q8
+/**
+ * @brief Replace the 16-bit weights with their quantized version.
+ */
+static void eval_quantize_all(void)
+{
+	EVAL_WEIGHT_Q8 = eval_quantize_weights();
+	eval_weight_free();
+	info("<Evaluation function weights quantized to 8 bits>\n");
+}
+#endif
+
+/**
+ * @brief Load the evaluation function features' weights.
+ *
+ * The weights are stored in a global variable, because, once loaded from the
+ * file, they stay constant during the lifetime of the program. As loading
+ * the weights is time & resource consuming, a counter variable check that
+ * the weights are effectively loaded only once.
+ * With the eval-cache option, the unpacked weights are mapped read-only from
+ * an image file, shared by all the processes using it. The image is rebuilt
+ * when it does not match the evaluation file any more.
+ * With the eval-type nnue option, the network of the nnue-file option is
+ * loaded instead of the pattern weights.
+ *
+ * @param file File name of the evaluation function data.
+ */
+void eval_open(const char* file)
+{
+	unsigned int version[3];
+
+	if (EVAL_LOADED++) return;
+
+	// the following is assumed:
+	//	-(unsigned) int are 32 bits
+	if (sizeof (int) != 4) fatal_error("int size is not compatible with Edax.\n");
+	//	-(unsigned) short are 16 bits
+	if (sizeof (short) != 2) fatal_error("short size is not compatible with Edax.\n");
+
+	OPPONENT_FEATURE = (unsigned short *) malloc(59049 * sizeof(unsigned short));	// 3^10
+	if (OPPONENT_FEATURE == NULL) fatal_error("Cannot allocate temporary table variable.\n");
+	set_opponent_feature(OPPONENT_FEATURE, 0, 10);
+
 	/*if (version == 3 && release == 2 && build == 5)*/ {
 		EVAL_A = -0.10026799, EVAL_B = 0.31027733, EVAL_C = -0.57772603;
 		EVAL_a = 0.07585621, EVAL_b = 1.16492647, EVAL_c = 5.4171698;
 	}
 
-	info("<Evaluation function weights version %u.%u.%u loaded>\n", version, release, build);
+	if (options.eval_type == EVAL_TYPE_NNUE) {
+		nnue_open(options.nnue_file ? options.nnue_file : "data/nnue.dat");
+		EVAL_NNUE = true;
+		return;
+	}
+
+	if (options.eval_cache_file == NULL || !eval_map_image(file, options.eval_cache_file, version)) {
+		eval_unpack(file, version);
+		if (options.eval_cache_file) eval_save_image(file, options.eval_cache_file, version);
+	}
 
-	// f = fopen("eval.bin", "wb");
-	// fwrite(*EVAL_WEIGHT, sizeof(Eval_weight), EVAL_N_PLY, f);
-	// fclose(f);
+#if EVAL_Q8
+	eval_quantize_all();
+#endif
+
+	info("<Evaluation function weights version %u.%u.%u loaded>\n", version[0], version[1], version[2]);
 }
 
 /**
@@ -719,8 +996,11 @@ void eval_open(const char* file)
 void eval_close(void)
 {
 	free(OPPONENT_FEATURE);
-	free(EVAL_WEIGHT);
-	EVAL_WEIGHT = NULL;
+	eval_weight_free();
+	free(EVAL_WEIGHT_Q8);
+	EVAL_WEIGHT_Q8 = NULL;
+	if (EVAL_NNUE) nnue_close();
+	EVAL_NNUE = false;
 }
 
 #ifdef ANDROID
@@ -740,6 +1020,11 @@ extern void eval_update_sse(int x, unsigned long long f, Eval *eval_out, const E
 void eval_set(Eval *eval, const Board *board)
 {
 	int	i, x;
+
+	if (EVAL_NNUE) {
+		nnue_set(eval, board);
+		return;
+	}
   #ifdef VECTOR_EVAL_UPDATE
 	unsigned long long b = (eval->n_empties & 1) ? board->opponent : board->player;
 
@@ -878,6 +1163,11 @@ void eval_update(int x, unsigned long long f, Eval *eval)
 {
 	assert(f);
 
+	if (EVAL_NNUE) {
+		nnue_update(x, f, eval, eval);
+		return;
+	}
+
   #if defined(USE_GAS_X86) || defined(USE_MSVC_X86) || defined(DISPATCH_NEON)
 	if (hasSSE2) {
 		eval_update_sse(x, f, eval, eval);
@@ -892,6 +1182,10 @@ void eval_update(int x, unsigned long long f, Eval *eval)
 
 void eval_update_leaf(int x, unsigned long long f, Eval *eval_out, const Eval *eval_in)
 {
+	if (EVAL_NNUE) {
+		nnue_update(x, f, eval_out, eval_in);
+		return;
+	}
   #if defined(USE_GAS_X86) || defined(USE_MSVC_X86) || defined(DISPATCH_NEON)
 	if (hasSSE2) {
 		eval_update_sse(x, f, eval_out, eval_in);
@@ -916,6 +1210,11 @@ void eval_pass(Eval *eval)
 {
 	int i;
 
+	if (EVAL_NNUE) {
+		nnue_pass(eval);
+		return;
+	}
+
 	for (i =  0; i <  4; ++i)	// 9
 		eval->feature.us[i] = OPPONENT_FEATURE[eval->feature.us[i] + 19683];
 	for (i =  4; i < 16; ++i)	// 10
@@ -954,3 +1253,182 @@ double eval_sigma(const int n_empty, const int depth, const int probcut_depth)
 
 	return sigma;
 }
+
+/**
+ * @brief Index of the weights of a ply.
+ *
+ * @param ply 60 - n_empties.
+ * @return The index in the weight array.
+ */
+static int eval_weight_index(int ply)
+{
+	if (ply >= EVAL_N_PLY)
+		ply = EVAL_N_PLY - 2 + (ply & 1);
+	ply -= 2;
+	if (ply < 0)
+		ply &= 1;
+	return ply;
+}
+
+/**
+ * @brief Evaluate features with 16-bit weights.
+ *
+ * @param w Weights of a ply.
+ * @param f Features.
+ * @return The evaluated score (in 1/128 discs).
+ */
+static int eval_accumulate(const Eval_weight *w, const unsigned short *f)
+{
+	int i, sum = w->S0;
+
+	for (i =  0; i <  4; ++i) sum += w->C9[f[i]];
+	for (i =  4; i <  8; ++i) sum += w->C10[f[i]];
+	for (i =  8; i < 12; ++i) sum += w->S100[f[i]];
+	for (i = 12; i < 16; ++i) sum += w->S101[f[i]];
+	for (i = 16; i < 30; ++i) sum += w->S8x4[f[i]];
+	for (i = 30; i < 46; ++i) sum += w->S7654[f[i]];
+
+	return sum;
+}
+
+/**
+ * @brief Evaluate features with quantized weights.
+ *
+ * The 8-bit weights of a pattern are summed up before being scaled.
+ *
+ * @param w Quantized weights of a ply.
+ * @param f Features.
+ * @return The evaluated score (in 1/128 discs).
+ */
+int eval_q8_accumulate(const Eval_weight_q8 *w, const unsigned short *f)
+{
+	return w->S0
+	  + w->scale[0] * (w->C9[f[ 0]] + w->C9[f[ 1]] + w->C9[f[ 2]] + w->C9[f[ 3]])
+	  + w->scale[1] * (w->C10[f[ 4]] + w->C10[f[ 5]] + w->C10[f[ 6]] + w->C10[f[ 7]])
+	  + w->scale[2] * (w->S100[f[ 8]] + w->S100[f[ 9]] + w->S100[f[10]] + w->S100[f[11]])
+	  + w->scale[3] * (w->S101[f[12]] + w->S101[f[13]] + w->S101[f[14]] + w->S101[f[15]])
+	  + w->scale[4] * (w->S8x4[f[16]] + w->S8x4[f[17]] + w->S8x4[f[18]] + w->S8x4[f[19]]
+	    + w->S8x4[f[20]] + w->S8x4[f[21]] + w->S8x4[f[22]] + w->S8x4[f[23]]
+	    + w->S8x4[f[24]] + w->S8x4[f[25]] + w->S8x4[f[26]] + w->S8x4[f[27]]
+	    + w->S8x4[f[28]] + w->S8x4[f[29]])
+	  + w->scale[5] * (w->S7654[f[30]] + w->S7654[f[31]] + w->S7654[f[32]] + w->S7654[f[33]]
+	    + w->S7654[f[34]] + w->S7654[f[35]] + w->S7654[f[36]] + w->S7654[f[37]]
+	    + w->S7654[f[38]] + w->S7654[f[39]] + w->S7654[f[40]] + w->S7654[f[41]]
+	    + w->S7654[f[42]] + w->S7654[f[43]] + w->S7654[f[44]] + w->S7654[f[45]]);
+}
+
+/**
+ * @brief Round an evaluation to a score in discs, as the search does.
+ *
+ * @param sum Evaluation (in 1/128 discs).
+ * @return The score.
+ */
+static int eval_round(int sum)
+{
+	if (sum > 0) sum += 64; else sum -= 64;
+	sum /= 128;
+	return MAX(SCORE_MIN + 1, MIN(SCORE_MAX - 1, sum));
+}
+
+/**
+ * @brief Start an accuracy report of the quantized weights.
+ *
+ * The 16-bit weights are quantized into a private copy, so the report is only
+ * available when the 16-bit weights are loaded (i.e. without EVAL_Q8).
+ *
+ * @param report Accuracy report.
+ * @return true if the report can be done.
+ */
+bool eval_q8_report_init(EvalQ8Report *report)
+{
+	memset(report, 0, sizeof (*report));
+	if (EVAL_WEIGHT == NULL) {
+		warn("The quantization report needs the 16-bit evaluation weights.\n");
+		return false;
+	}
+	report->weight = eval_quantize_weights();
+	return true;
+}
+
+/**
+ * @brief Compare the quantized to the 16-bit evaluation of a position.
+ *
+ * The position itself is evaluated, then its children to compare the best
+ * move at depth 1.
+ *
+ * @param report Accuracy report.
+ * @param board Position.
+ */
+void eval_q8_report_add(EvalQ8Report *report, const Board *board)
+{
+	Eval eval;
+	Board next;
+	unsigned long long moves;
+	int x, i, s16, s8, best16, best8, x16, x8;
+	double error;
+
+	eval.n_empties = board_count_empties(board);
+	eval_set(&eval, board);
+	i = eval_weight_index(60 - eval.n_empties);
+	s16 = eval_accumulate(&(*EVAL_WEIGHT)[i], eval.feature.us);
+	s8 = eval_q8_accumulate(&(*report->weight)[i], eval.feature.us);
+
+	error = abs(s8 - s16) / 128.0;
+	++report->n;
+	report->sum_error += error;
+	report->sum_error2 += error * error;
+	report->max_error = MAX(report->max_error, error);
+	if (eval_round(s16) != eval_round(s8)) ++report->n_score_diff;
+
+	moves = board_get_moves(board);
+	if (moves) {
+		best16 = best8 = INT_MAX;	// min stage
+		x16 = x8 = NOMOVE;
+		i = eval_weight_index(60 - eval.n_empties + 1);
+		foreach_bit (x, moves) {
+			board_next(board, x, &next);
+			eval.n_empties = board_count_empties(&next);
+			eval_set(&eval, &next);
+			s16 = eval_accumulate(&(*EVAL_WEIGHT)[i], eval.feature.us);
+			s8 = eval_q8_accumulate(&(*report->weight)[i], eval.feature.us);
+			if (s16 < best16) { best16 = s16; x16 = x; }
+			if (s8 < best8) { best8 = s8; x8 = x; }
+		}
+		++report->n_move;
+		if (x16 != x8) ++report->n_move_diff;
+	}
+}
+
+/**
+ * @brief Print an accuracy report of the quantized weights.
+ *
+ * @param report Accuracy report.
+ * @param f Output stream.
+ */
+void eval_q8_report_print(const EvalQ8Report *report, FILE *f)
+{
+	size_t size16 = sizeof (Eval_weight) * (EVAL_N_PLY - 2), size8 = sizeof (Eval_weight_q8) * (EVAL_N_PLY - 2);
+
+	fprintf(f, "weights: %.1f MB (16-bit) -> %.1f MB (8-bit)\n", size16 / 1048576.0, size8 / 1048576.0);
+	if (report->n == 0) {
+		fprintf(f, "no position evaluated\n");
+		return;
+	}
+	fprintf(f, "positions: %llu\n", report->n);
+	fprintf(f, "error (discs): mean %.3f, rms %.3f, max %.3f\n", report->sum_error / report->n,
+		sqrt(report->sum_error2 / report->n), report->max_error);
+	fprintf(f, "different scores: %llu (%.2f%%)\n", report->n_score_diff, 100.0 * report->n_score_diff / report->n);
+	if (report->n_move) fprintf(f, "different best moves at depth 1: %llu / %llu (%.2f%%)\n",
+		report->n_move_diff, report->n_move, 100.0 * report->n_move_diff / report->n_move);
+}
+
+/**
+ * @brief Free an accuracy report.
+ *
+ * @param report Accuracy report.
+ */
+void eval_q8_report_free(EvalQ8Report *report)
+{
+	free(report->weight);
+	report->weight = NULL;
+}
@@ -59,6 +59,35 @@ enum { EVAL_N_PLY = 54 };	// decreased from 60 in 4.5.1
 
 extern Eval_weight (*EVAL_WEIGHT)[EVAL_N_PLY - 2];	// for 2..53
 
+/** evaluation by the neural network (-eval-type nnue) instead of the patterns */
+extern bool EVAL_NNUE;
+
+/** quantized weights: 8-bit entries with a scale per pattern */
+typedef struct Eval_weight_q8 {
+	short	S0;
+	short	scale[6];	// C9, C10, S100, S101, S8x4, S7654
+	signed char	C9[19683];
+	signed char	C10[59049];
+	signed char	S100[59049];
+	signed char	S101[59049];
+	signed char	S8x4[6561*4];
+	signed char	S7654[2187+729+243+81];
+} Eval_weight_q8;
+
+extern Eval_weight_q8 (*EVAL_WEIGHT_Q8)[EVAL_N_PLY - 2];	// with EVAL_Q8
+
+/** accuracy of the quantized weights against the 16-bit weights */
+typedef struct EvalQ8Report {
+	Eval_weight_q8 (*weight)[EVAL_N_PLY - 2]; /**< quantized weights */
+	unsigned long long n;                     /**< number of positions */
+	unsigned long long n_score_diff;          /**< positions with a different score (in discs) */
+	unsigned long long n_move;                /**< positions with a best move */
+	unsigned long long n_move_diff;           /**< positions with a different best move (at depth 1) */
+	double sum_error;                         /**< sum of the absolute errors (in discs) */
+	double sum_error2;                        /**< sum of the squared errors */
+	double max_error;                         /**< largest absolute error */
+} EvalQ8Report;
+
 /* function declaration */
 void eval_open(const char*);
 void eval_close(void);
@@ -68,17 +97,24 @@ void eval_set(Eval*, const struct Board*);
 void eval_restore(Eval*, const struct Move*);
 void eval_pass(Eval*);
 double eval_sigma(const int, const int, const int);
+int eval_q8_accumulate(const Eval_weight_q8*, const unsigned short*);
+bool eval_q8_report_init(EvalQ8Report*);
+void eval_q8_report_add(EvalQ8Report*, const struct Board*);
+void eval_q8_report_print(const EvalQ8Report*, FILE*);
+void eval_q8_report_free(EvalQ8Report*);
 
 #if defined(hasSSE2) || defined(__ARM_NEON) || defined(USE_MSVC_X86) || defined(ANDROID)
 void eval_update_sse(int, unsigned long long, Eval *, const Eval *);
 #endif
 #if defined(hasSSE2) || defined(__ARM_NEON)
-#define	eval_update(x, f, eval)	eval_update_sse(x, f, eval, eval)
-#define	eval_update_leaf(x, f, eval_out, eval_in)	eval_update_sse(x, f, eval_out, eval_in)
+#define	eval_update(x, f, eval)	eval_update_leaf(x, f, eval, eval)
+#define	eval_update_leaf(x, f, eval_out, eval_in)	(EVAL_NNUE ? nnue_update(x, f, eval_out, eval_in) : eval_update_sse(x, f, eval_out, eval_in))
 #else
 void eval_update(int, unsigned long long, Eval*);
 void eval_update_leaf(int, unsigned long long, Eval*, const Eval*);
 #endif
 
+#include "nnue.h"	// nnue_update() for eval_update_leaf()
+
 #endif
 
@@ -14,6 +14,7 @@
 #include "board.h"
 #include "move.h"
 #include "eval.h"
+#include "settings.h"
 
 extern const EVAL_FEATURE_V EVAL_FEATURE[65];
 extern const EVAL_FEATURE_V EVAL_FEATURE_all_opponent;
@@ -29,7 +30,33 @@ extern const EVAL_FEATURE_V EVAL_FEATURE_all_opponent;
 
 void eval_update_sse(int x, unsigned long long f, Eval *eval_out, const Eval *eval_in)
 {
-  #ifdef __AVX2__
+  #if EVAL_AVX512	// 32 + 16 features
+	__m512i	f0 = _mm512_loadu_si512(&eval_in->feature.us[0]);
+	__m256i	f1 = eval_in->feature.v16[2];
+
+	if (eval_in->n_empties & 1) {
+		f0 = _mm512_sub_epi16(f0, _mm512_loadu_si512(&EVAL_FEATURE[x].us[0]));
+		f1 = _mm256_sub_epi16(f1, EVAL_FEATURE[x].v16[2]);
+
+		foreach_bit (x, f) {
+			f0 = _mm512_add_epi16(f0, _mm512_loadu_si512(&EVAL_FEATURE[x].us[0]));
+			f1 = _mm256_add_epi16(f1, EVAL_FEATURE[x].v16[2]);
+		}
+
+	} else {
+		f0 = _mm512_sub_epi16(f0, _mm512_slli_epi16(_mm512_loadu_si512(&EVAL_FEATURE[x].us[0]), 1));
+		f1 = _mm256_sub_epi16(f1, _mm256_slli_epi16(EVAL_FEATURE[x].v16[2], 1));
+
+		foreach_bit (x, f) {
+			f0 = _mm512_sub_epi16(f0, _mm512_loadu_si512(&EVAL_FEATURE[x].us[0]));
+			f1 = _mm256_sub_epi16(f1, EVAL_FEATURE[x].v16[2]);
+		}
+	}
+
+	_mm512_storeu_si512(&eval_out->feature.us[0], f0);
+	eval_out->feature.v16[2] = f1;
+
+  #elif defined(__AVX2__)
 	__m256i	f0 = eval_in->feature.v16[0];
 	__m256i	f1 = eval_in->feature.v16[1];
 	__m256i	f2 = eval_in->feature.v16[2];
@@ -201,7 +228,14 @@ void eval_update_sse(int x, unsigned long long f, Eval *eval_out, const Eval *ev
 void eval_set(Eval *eval, const Board *board)
 {
 	int x;
-	unsigned long long b = (eval->n_empties & 1) ? board->opponent : board->player;
+	unsigned long long b;
+
+	if (EVAL_NNUE) {
+		nnue_set(eval, board);
+		return;
+	}
+
+	b = (eval->n_empties & 1) ? board->opponent : board->player;
   #ifdef __AVX2__
 	__m256i	f0 = EVAL_FEATURE_all_opponent.v16[0];
 	__m256i	f1 = EVAL_FEATURE_all_opponent.v16[1];
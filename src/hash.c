@@ -13,6 +13,9 @@
  * The following implementation store the whole board to avoid collision. 
  * When doing parallel search with a shared hashtable, a locked implementation
  * avoid concurrency collisions.
+ * Alternatively (USE_HASH_LOCKLESS), a lockless implementation storing 16-byte
+ * entries verified by the hash code, or compact 8-byte entries verified by its
+ * high bits (USE_HASH_LOCKLESS == 2), can be found in hash_lockless.c.
  *
  * @date 1998 - 2023
  * @author Richard Delorme
@@ -35,66 +38,154 @@
 const HashData HASH_DATA_INIT = {{{ 0, 0, 0, 0 }}, -SCORE_INF, SCORE_INF, { NOMOVE, NOMOVE }};
 
 /**
- * @brief Initialise the hashtable.
- *
- * Allocate the hash table entries and initialise the hash masks.
+ * @brief Set the hash masks & the locks of an allocated hashtable.
  *
  * @param hash_table Hash table to setup.
+ * @param entries Memory of the entries.
  * @param size Requested size for the hash table in number of entries.
  */
-void hash_init(HashTable *hash_table, const unsigned long long size)
+static void hash_layout(HashTable *hash_table, void *entries, const unsigned long long size)
 {
 	int i, n_way;
 
 	for (n_way = 1; n_way < HASH_N_WAY; n_way <<= 1);	// round up HASH_N_WAY to 2 ^ n
 
-	assert(hash_table != NULL);
-	assert((n_way & -n_way) == n_way);
-
-	info("< init hashtable of %llu entries>\n", size);
-	if (hash_table->hash != NULL) free(hash_table->memory);
-	hash_table->memory = malloc((size + n_way + 1) * sizeof (Hash));
-	if (hash_table->memory == NULL) {
-		fatal_error("hash_init: cannot allocate the hash table\n");
-	}
-
 	if (HASH_ALIGNED) {
 		size_t alignment = n_way * sizeof (Hash);	// (4 * 24)
 		alignment = (alignment & -alignment) - 1;	// LS1B - 1 (0x1f)
-		hash_table->hash = (Hash*) (((size_t) hash_table->memory + alignment) & ~alignment);
+		hash_table->hash = (Hash*) (((size_t) entries + alignment) & ~alignment);
 		hash_table->hash_mask = size - n_way;
 	} else {
-		hash_table->hash = (Hash*) hash_table->memory;
+		hash_table->hash = (Hash*) entries;
 		hash_table->hash_mask = size - 1;
 	}
 
-	hash_cleanup(hash_table);
-
+#if USE_HASH_LOCKLESS
+	hash_table->n_lock = 0;
+	hash_table->lock_mask = 0;
+	hash_table->lock = NULL;
+#else
 	hash_table->n_lock = 1 << (31 - lzcnt_u32(get_cpu_number() | 1) + 8);	// round down to 2 ^ n, then * 256
 	hash_table->lock_mask = hash_table->n_lock - 1;
 	// hash_table->n_lock += n_way + 1;
 	hash_table->lock = (HashLock*) malloc(hash_table->n_lock * sizeof (HashLock));
+#endif
 
-	for (i = 0; i < hash_table->n_lock; ++i) spin_init(hash_table->lock + i);
+	for (i = 0; i < hash_table->n_lock; ++i) {
+		spin_init(hash_table->lock + i);
+		hash_table->lock[i].n_contention = 0;
+	}
 }
 
 /**
- * @brief Clear the hashtable.
+ * @brief Initialise the hashtable.
  *
- * Set all hash table entries to zero.
- * @param hash_table Hash table to clear.
+ * Allocate the hash table entries and initialise the hash masks.
+ * Large tables may use huge pages and be interleaved over NUMA nodes
+ * (see large_alloc()).
+ *
+ * @param hash_table Hash table to setup.
+ * @param size Requested size for the hash table in number of entries.
  */
-void hash_cleanup(HashTable *hash_table)
+void hash_init(HashTable *hash_table, const unsigned long long size)
 {
-	unsigned int i = 0, imax = hash_table->hash_mask + HASH_N_WAY;
-	Hash *pHash = hash_table->hash;
+	int n_way;
 
-	assert(hash_table != NULL && hash_table->hash != NULL);
+	for (n_way = 1; n_way < HASH_N_WAY; n_way <<= 1);	// round up HASH_N_WAY to 2 ^ n
+
+	assert(hash_table != NULL);
+	assert((n_way & -n_way) == n_way);
+
+	info("< init hashtable of %llu entries>\n", size);
+	if (hash_table->hash != NULL) hash_free(hash_table);
+	hash_table->memory = large_alloc((size + n_way + 1) * sizeof (Hash), options.hash_huge_pages, options.hash_numa_interleave, &hash_table->memory_mapped);
+	if (hash_table->memory == NULL) {
+		fatal_error("hash_init: cannot allocate the hash table\n");
+	}
+	hash_table->shared = false;
+	hash_table->shared_date = NULL;
+	hash_table->shared_name = NULL;
+
+	hash_layout(hash_table, hash_table->memory, size);
+	hash_cleanup(hash_table);
+}
+
+/** size of the header of a shared hash table, before its entries (a cache line) */
+#define HASH_SHARED_HEADER_SIZE 64
 
-	info("< cleaning hashtable >\n");
+/**
+ * @brief Initialise the hashtable in a named shared memory.
+ *
+ * Several processes using the same name and the same hash table size share
+ * the table entries. The table is zero-filled when created, and kept as is
+ * when attached. Its header holds the latest date of the processes, so that
+ * an attaching process goes on with the date of the others. The process that
+ * created the shared memory removes it when it frees the table.
+ * Only the lockless entries are safe between processes, as the locks of the
+ * locked entries would be private to each process: the -hash-shared option is
+ * rejected by the other builds. On failure, the table is allocated in private
+ * memory.
+ *
+ * @param hash_table Hash table to setup.
+ * @param size Requested size for the hash table in number of entries.
+ * @param name Shared memory name.
+ */
+void hash_init_shared(HashTable *hash_table, const unsigned long long size, const char *name)
+{
+#if USE_HASH_LOCKLESS
+	int n_way;
+	bool created;
+
+	for (n_way = 1; n_way < HASH_N_WAY; n_way <<= 1);	// round up HASH_N_WAY to 2 ^ n
+
+	assert(hash_table != NULL);
+
+	info("< init shared hashtable of %llu entries>\n", size);
+	if (hash_table->hash != NULL) hash_free(hash_table);
+	hash_table->memory = shared_alloc(name, HASH_SHARED_HEADER_SIZE + (size + n_way + 1) * sizeof (Hash), &hash_table->memory_mapped, &created);
+	if (hash_table->memory == NULL) {
+		warn("hash_init_shared: using a private hash table\n");
+		hash_init(hash_table, size);
+		return;
+	}
+	hash_table->shared = true;
+	hash_table->warm = false;
+	hash_table->shared_date = (volatile unsigned char *) hash_table->memory;
+	if (created || *hash_table->shared_date == 0) *hash_table->shared_date = 1;
+	hash_table->date = *hash_table->shared_date;
+	hash_table->shared_name = created ? string_duplicate(name) : NULL;
+
+	hash_layout(hash_table, (char *) hash_table->memory + HASH_SHARED_HEADER_SIZE, size);
+#else
+	(void) name;
+	warn("hash_init_shared: a shared hash table needs lockless entries (USE_HASH_LOCKLESS); using a private hash table\n");
+	hash_init(hash_table, size);
+#endif
+}
+
+/** HashCleanupTask : slice of the hash table to clear by a thread */
+typedef struct HashCleanupTask {
+	Hash *hash;                   /*!< first entry to clear */
+	unsigned long long n;         /*!< number of entries to clear */
+	Thread thread;                /*!< thread clearing the slice */
+} HashCleanupTask;
+
+static void hash_cleanup_slice(Hash*, const unsigned long long);
+
+#if !USE_HASH_LOCKLESS
+/**
+ * @brief Clear a slice of the hashtable.
+ *
+ * Set the hash table entries to zero.
+ * @param pHash First entry to clear.
+ * @param n Number of entries to clear.
+ */
+static void hash_cleanup_slice(Hash *pHash, const unsigned long long n)
+{
+	unsigned long long i = 0;
 
   #if defined(hasSSE2) || defined(USE_MSVC_X86)
-	if (hasSSE2 && (sizeof(Hash) == 24) && (((size_t) pHash & 0x1f) == 0) && (imax >= 7)) {
+	if (hasSSE2 && (sizeof(Hash) == 24) && (((size_t) pHash & 0x1f) == 0) && (n >= 8)) {
 		for (; i < 4; ++i, ++pHash) {
 			HASH_COLLISIONS(pHash->key = 0;)
 			pHash->board.player = pHash->board.opponent = 0;
@@ -104,7 +195,7 @@ void hash_cleanup(HashTable *hash_table)
 		__m256i d0 = _mm256_load_si256((__m256i *)(pHash - 4));
 		__m256i d1 = _mm256_load_si256((__m256i *)(pHash - 4) + 1);
 		__m256i d2 = _mm256_load_si256((__m256i *)(pHash - 4) + 2);
-		for (i = 4; i <= imax - 3; i += 4, pHash += 4) {
+		for (i = 4; i + 4 <= n; i += 4, pHash += 4) {
 			_mm256_stream_si256((__m256i *) pHash, d0);
 			_mm256_stream_si256((__m256i *) pHash + 1, d1);
 			_mm256_stream_si256((__m256i *) pHash + 2, d2);
@@ -113,7 +204,7 @@ void hash_cleanup(HashTable *hash_table)
 		__m128i d0 = _mm_load_si128((__m128i *)(pHash - 4));
 		__m128i d1 = _mm_load_si128((__m128i *)(pHash - 4) + 1);
 		__m128i d2 = _mm_load_si128((__m128i *)(pHash - 4) + 2);
-		for (i = 4; i <= imax - 1; i += 2, pHash += 2) {
+		for (i = 4; i + 2 <= n; i += 2, pHash += 2) {
 			_mm_stream_si128((__m128i *) pHash, d0);
 			_mm_stream_si128((__m128i *) pHash + 1, d1);
 			_mm_stream_si128((__m128i *) pHash + 2, d2);
@@ -122,12 +213,78 @@ void hash_cleanup(HashTable *hash_table)
 		_mm_sfence();
 	}
   #endif
-	for (; i <= imax; ++i, ++pHash) {
+	for (; i < n; ++i, ++pHash) {
 		HASH_COLLISIONS(pHash->key = 0;)
 		pHash->board.player = pHash->board.opponent = 0; 
 		pHash->data = HASH_DATA_INIT;
 	}
+}
+#endif
+
+/**
+ * @brief Clear a slice of the hashtable from a thread.
+ *
+ * @param data Slice to clear.
+ * @return NULL.
+ */
+static void* hash_cleanup_thread(void *data)
+{
+	HashCleanupTask *task = (HashCleanupTask*) data;
+
+	hash_cleanup_slice(task->hash, task->n);
+	return NULL;
+}
+
+/**
+ * @brief Clear the hashtable.
+ *
+ * Set all hash table entries to zero.
+ * Large tables are cleared in parallel by n_task threads, each one clearing
+ * (and so first touching) a contiguous slice of buckets. With cpu affinity,
+ * the threads run on the same cpus than the search tasks, so that the memory
+ * pages are allocated on the NUMA node that uses them the most.
+ *
+ * @param hash_table Hash table to clear.
+ */
+void hash_cleanup(HashTable *hash_table)
+{
+	const unsigned long long n = hash_table->hash_mask + HASH_N_WAY + 1;
+	unsigned long long slice;
+	HashCleanupTask *task;
+	int i, n_tasks, n_way;
+
+	assert(hash_table != NULL && hash_table->hash != NULL);
+
+	n_tasks = MIN(options.n_task, MAX_THREADS);
+	if (n < ((unsigned long long) n_tasks << 18)) n_tasks = (int) (n >> 18);	// at least 256K entries per thread
+	if (n_tasks < 1) n_tasks = 1;
+
+	task = (HashCleanupTask*) malloc(n_tasks * sizeof (HashCleanupTask));
+	if (task == NULL) {
+		hash_cleanup_slice(hash_table->hash, n);
+		hash_table->date = 0;
+		hash_table->warm = false;
+		return;
+	}
+
+	info("< cleaning hashtable (%d threads) >\n", n_tasks);
+
+	for (n_way = 1; n_way < HASH_N_WAY; n_way <<= 1);	// round up HASH_N_WAY to 2 ^ n
+	slice = (n / n_tasks) & ~(unsigned long long) (n_way - 1);	// whole buckets, to keep alignment
+	for (i = 0; i < n_tasks; ++i) {
+		task[i].hash = hash_table->hash + i * slice;
+		task[i].n = (i == n_tasks - 1) ? n - i * slice : slice;
+	}
+	for (i = 1; i < n_tasks; ++i) {
+		thread_create(&task[i].thread, hash_cleanup_thread, task + i);
+		if (options.cpu_affinity) thread_set_cpu(task[i].thread, i);
+	}
+	hash_cleanup_slice(task[0].hash, task[0].n);
+	for (i = 1; i < n_tasks; ++i) thread_join(task[i].thread);
+	free(task);
+
 	hash_table->date = 0;
+	hash_table->warm = false;
 }
 
 /**
@@ -140,10 +297,16 @@ void hash_clear(HashTable *hash_table)
 {
 	assert(hash_table != NULL);
 
-	if (hash_table->date == 127) hash_cleanup(hash_table);
+	if (hash_table->shared) {	// go on with the latest date of the processes, without erasing their entries
+		hash_table->date = *hash_table->shared_date;
+		if (hash_table->date >= HASH_DATE_MAX) hash_table->date = 0;
+		*hash_table->shared_date = hash_table->date + 1;
+	} else if (hash_table->date == HASH_DATE_MAX) {
+		hash_cleanup(hash_table);
+	}
 	++hash_table->date;
 	info("< clearing hashtable -> date = %d>\n", hash_table->date);
-	assert(hash_table->date > 0 && hash_table->date <= 127);
+	assert(hash_table->date > 0 && hash_table->date <= HASH_DATE_MAX);
 }
 
 /**
@@ -157,10 +320,19 @@ void hash_free(HashTable *hash_table)
 	int i;
 
 	assert(hash_table != NULL && hash_table->hash != NULL);
-	free(hash_table->memory);
+	large_free(hash_table->memory, hash_table->memory_mapped);
 	hash_table->hash = NULL;
+	hash_table->shared = false;
+	hash_table->shared_date = NULL;
+	if (hash_table->shared_name) {
+		shared_unlink(hash_table->shared_name);
+		free(hash_table->shared_name);
+		hash_table->shared_name = NULL;
+	}
 	for (i = 0; i < hash_table->n_lock; ++i) spin_free(hash_table->lock + i);
 	free(hash_table->lock);
+	hash_table->lock = NULL;
+	hash_table->n_lock = 0;
 }
 
 /**
@@ -178,6 +350,20 @@ inline unsigned int writeable_level(HashData *data)
 #endif
 }
 
+/**
+ * @brief make a level from depth, selectivity & cost, without the date.
+ *
+ * Used to keep the deepest entry in the first way of a bucket with the split
+ * policy, whatever its date.
+ *
+ * @param data Hash data.
+ * @return A level.
+ */
+static inline unsigned int preferred_level(const HashData *data)
+{
+	return (data->wl.c.depth << 16) + (data->wl.c.selectivity << 8) + data->wl.c.cost;
+}
+
 /**
  * @brief update an hash table item.
  *
@@ -263,6 +449,86 @@ static void data_new(HashData *data, HashStoreData *storedata)
 	assert(data->upper >= data->lower);
 }
 
+#if USE_HASH_LOCKLESS
+#include "hash_lockless.c"
+#else
+
+/**
+ * @brief Get the hash code of an hash entry.
+ *
+ * @param hash Hash Entry.
+ * @return The hash code, or 0 for an empty entry.
+ */
+static inline unsigned long long hash_entry_code(const Hash *hash)
+{
+	if ((hash->board.player | hash->board.opponent) == 0) return 0;
+	return board_get_hash_code(&hash->board);
+}
+
+/**
+ * @brief Get the data of an hash entry.
+ *
+ * @param hash Hash Entry.
+ * @return The hash data.
+ */
+static inline HashData hash_entry_data(const Hash *hash)
+{
+	return hash->data;
+}
+
+/**
+ * @brief Check if an hash entry is used.
+ *
+ * @param hash Hash Entry.
+ * @return true if the entry is used.
+ */
+static inline bool hash_entry_used(const Hash *hash)
+{
+	return (hash->board.player | hash->board.opponent) != 0;
+}
+
+/**
+ * @brief Change the data of an hash entry.
+ *
+ * @param hash Hash Entry.
+ * @param data New hash data.
+ */
+static inline void hash_entry_set_data(Hash *hash, const HashData *data)
+{
+	hash->data = *data;
+}
+
+/**
+ * @brief Lock a bucket, counting the contention.
+ *
+ * @param lock Lock.
+ */
+static inline void hash_lock(HashLock *lock)
+{
+	if (!spin_trylock(lock)) {
+		spin_lock(lock);
+		++lock->n_contention;
+	}
+}
+
+/**
+ * @brief Count the replacement of another position.
+ *
+ * The counters belong to the search thread using this copy of the table.
+ *
+ * @param hash_table Hash table.
+ * @param hash Replaced entry.
+ */
+static inline void hash_count_overwrite(HashTable *hash_table, const Hash *hash)
+{
+	HashCount *count = hash_table->count;
+
+	if (count && hash_entry_used(hash)) {
+		++count->n_overwrite;
+		if (hash->data.wl.c.date == hash_table->date) ++count->n_collision;
+	}
+}
+
 /**
  * @brief Initialize a new hash table item.
  *
@@ -272,6 +538,7 @@ static void data_new(HashData *data, HashStoreData *storedata)
  * safe structure ; so that any corrupted entry won't be readable.
  *
  * @param hash Hash Entry.
+ * @param demote Entry receiving the previous content of the hash entry, or NULL.
  * @param lock Lock.
  * @param hash_code Hash code.
  * @param storedata.data.date Hash date.
@@ -283,10 +550,11 @@ static void data_new(HashData *data, HashStoreData *storedata)
  * @param storedata.score Best score.
  * @param storedata.move Best move.
  */
-static void hash_new(Hash *hash, HashLock *lock, const Board *board, HashStoreData *storedata)
+static void hash_new(Hash *hash, Hash *demote, HashLock *lock, const Board *board, HashStoreData *storedata)
 {
-	spin_lock(lock);
-	HASH_STATS(if (date == hash->data.date) ++statistics.n_hash_remove;)
+	hash_lock(lock);
+	if (demote) *demote = *hash;
+	HASH_STATS(if (hash->data.wl.c.date == storedata->data.wl.c.date) ++statistics.n_hash_remove;)
 	HASH_STATS(++statistics.n_hash_new;)
 	HASH_COLLISIONS(hash->key = storedata->hash_code;)
 	hash->board = *board;
@@ -303,6 +571,7 @@ static void hash_new(Hash *hash, HashLock *lock, const Board *board, HashStoreDa
  * safe structure ; so that any corrupted entry won't be readable.
  *
  * @param hash Hash Entry.
+ * @param demote Entry receiving the previous content of the hash entry, or NULL.
  * @param lock Lock.
  * @param board Bitboard.
  * @param storedata.data.date Hash date.
@@ -313,11 +582,12 @@ static void hash_new(Hash *hash, HashLock *lock, const Board *board, HashStoreDa
  * @param storedata.data.upper Upper score bound.
  * @param storedata.move Best move.
  */
-static void hash_set(Hash *hash, HashLock *lock, const Board *board, HashStoreData *storedata)
+static void hash_set(Hash *hash, Hash *demote, HashLock *lock, const Board *board, HashStoreData *storedata)
 {
 	storedata->data.move[1] = NOMOVE;
-	spin_lock(lock);
-	HASH_STATS(if (date == hash->data.date) ++statistics.n_hash_remove;)
+	hash_lock(lock);
+	if (demote) *demote = *hash;
+	HASH_STATS(if (hash->data.wl.c.date == storedata->data.wl.c.date) ++statistics.n_hash_remove;)
 	HASH_STATS(++statistics.n_hash_new;)
 	HASH_COLLISIONS(hash->key = storedata->hash_code;)
 	hash->board = *board;
@@ -353,7 +623,7 @@ static bool hash_update(Hash *hash, HashLock *lock, const Board *board, HashStor
 	bool ok = false;
 
 	if (board_equal(&hash->board, board)) {
-		spin_lock(lock);
+		hash_lock(lock);
 		if (board_equal(&hash->board, board)) {
 			if (hash->data.wl.us.selectivity_depth == storedata->data.wl.us.selectivity_depth)
 				data_update(&hash->data, storedata);
@@ -395,7 +665,7 @@ static bool hash_replace(Hash *hash, HashLock *lock, const Board *board, HashSto
 	bool ok = false;
 
 	if (board_equal(&hash->board, board)) {
-		spin_lock(lock);
+		hash_lock(lock);
 		if (board_equal(&hash->board, board)) {
 			data_new(&hash->data, storedata);
 			ok = true;
@@ -423,7 +693,7 @@ static bool hash_reset(Hash *hash, HashLock *lock, const Board *board, HashStore
 	bool ok = false;
 
 	if (board_equal(&hash->board, board)) {
-		spin_lock(lock);
+		hash_lock(lock);
 		if (board_equal(&hash->board, board)) {
 			if (hash->data.wl.us.selectivity_depth == storedata->data.wl.us.selectivity_depth) {
 				if (hash->data.lower < storedata->data.lower) hash->data.lower = storedata->data.lower;
@@ -448,6 +718,46 @@ static bool hash_reset(Hash *hash, HashLock *lock, const Board *board, HashStore
 	return ok;
 }
 
+/**
+ * @brief Choose the entry to replace with the split policy.
+ *
+ * The first way of a bucket is depth-preferred: it keeps the entry of highest
+ * depth, selectivity & cost, whatever its date. The other ways are always
+ * replaced, the lowest level (date first) first. A new entry at least as deep
+ * as the first one takes its place, and the previous first entry is moved
+ * down to an always-replace way, by the caller, under the same lock as the
+ * insertion.
+ *
+ * @param bucket First way of the bucket.
+ * @param data New data.
+ * @param demote Output entry receiving the previous first entry, or NULL.
+ * @return The entry to replace.
+ */
+static Hash* hash_split_victim(Hash *bucket, HashData *data, Hash **demote)
+{
+	Hash *worst, *hash;
+	int i;
+
+	*demote = NULL;
+	if (HASH_N_WAY < 2) return bucket;
+
+	worst = hash = bucket + 1;
+	for (i = 2; i < HASH_N_WAY; ++i) {
+		++hash;
+		if (writeable_level(&worst->data) > writeable_level(&hash->data)) {
+			worst = hash;
+		}
+	}
+
+	if (!hash_entry_used(bucket)) return bucket;
+	if (preferred_level(data) >= preferred_level(&bucket->data)) {
+		*demote = worst;
+		HASH_STATS(++statistics.n_hash_demote;)
+		return bucket;
+	}
+	return worst;
+}
+
 /**
  * @brief feed hash table (from Cassio).
  *
@@ -461,7 +771,7 @@ static bool hash_reset(Hash *hash, HashLock *lock, const Board *board, HashStore
  */
 void hash_feed(HashTable *hash_table, const Board *board, const unsigned long long hash_code, HashStoreData *storedata)
 {
-	Hash *hash, *worst;
+	Hash *hash, *worst, *demote = NULL;
 	HashLock *lock; 
 	int i;
 
@@ -481,8 +791,10 @@ void hash_feed(HashTable *hash_table, const Board *board, const unsigned long lo
 	}
 
 	// new entry
+	if (options.hash_policy == HASH_POLICY_SPLIT) worst = hash_split_victim(hash_table->hash + (hash_code & hash_table->hash_mask), &storedata->data, &demote);
+	hash_count_overwrite(hash_table, demote ? demote : worst);
 	HASH_COLLISIONS(storedata->hash_code = hash_code;)
-	hash_set(worst, lock, board, storedata);
+	hash_set(worst, demote, lock, board, storedata);
 }
 
 /**
@@ -502,6 +814,8 @@ void hash_feed(HashTable *hash_table, const Board *board, const unsigned long lo
  *     -if (score > alpha) update the lower bound of the hash entry
  * The best move is also stored, but only if score >= alpha. In case the entry
  * already exists with better data, nothing is stored.
+ * A new entry replaces the lowest level entry of the bucket, or, with the split
+ * policy, the entry chosen by hash_split_victim().
  *
  * @param hash_table Hash table to update.
  * @param board Bitboard.
@@ -517,7 +831,7 @@ void hash_feed(HashTable *hash_table, const Board *board, const unsigned long lo
 void hash_store(HashTable *hash_table, const Board *board, const unsigned long long hash_code, HashStoreData *storedata)
 {
 	int i;
-	Hash *worst, *hash;
+	Hash *worst, *hash, *demote = NULL;
 	HashLock *lock;
 
 	worst = hash = hash_table->hash + (hash_code & hash_table->hash_mask);
@@ -533,8 +847,10 @@ void hash_store(HashTable *hash_table, const Board *board, const unsigned long l
 		}
 	}
 
+	if (options.hash_policy == HASH_POLICY_SPLIT) worst = hash_split_victim(hash_table->hash + (hash_code & hash_table->hash_mask), &storedata->data, &demote);
+	hash_count_overwrite(hash_table, demote ? demote : worst);
 	HASH_COLLISIONS(storedata->hash_code = hash_code;)
-	hash_new(worst, lock, board, storedata);
+	hash_new(worst, demote, lock, board, storedata);
 }
 
 /**
@@ -556,7 +872,7 @@ void hash_store(HashTable *hash_table, const Board *board, const unsigned long l
 void hash_force(HashTable *hash_table, const Board *board, const unsigned long long hash_code, HashStoreData *storedata)
 {
 	int i;
-	Hash *worst, *hash;
+	Hash *worst, *hash, *demote = NULL;
 	HashLock *lock;
 
 	worst = hash = hash_table->hash + (hash_code & hash_table->hash_mask);
@@ -572,8 +888,10 @@ void hash_force(HashTable *hash_table, const Board *board, const unsigned long l
 		}
 	}
 
+	if (options.hash_policy == HASH_POLICY_SPLIT) worst = hash_split_victim(hash_table->hash + (hash_code & hash_table->hash_mask), &storedata->data, &demote);
+	hash_count_overwrite(hash_table, demote ? demote : worst);
 	HASH_COLLISIONS(storedata->hash_code = hash_code;)
-	hash_new(worst, lock, board, storedata);
+	hash_new(worst, demote, lock, board, storedata);
 }
 
 /**
@@ -609,10 +927,11 @@ bool hash_get(HashTable *hash_table, const Board *board, const unsigned long lon
 		HASH_COLLISIONS(})
 		if (board_equal(&hash->board, board)) {
 			lock = hash_table->lock + (hash_code & hash_table->lock_mask);
-			spin_lock(lock);
+			hash_lock(lock);
 			if (board_equal(&hash->board, board)) {
 				*data = hash->data;
 				HASH_STATS(++statistics.n_hash_found;)
+				HASH_STATS(if (i == 0) ++statistics.n_hash_found_first;)
 				hash->data.wl.c.date = hash_table->date;
 				ok = true;
 			}
@@ -625,19 +944,6 @@ bool hash_get(HashTable *hash_table, const Board *board, const unsigned long lon
 	return false;
 }
 
-/**
- * @brief Find an hash table entry from the board.
- *
- * @param hash_table Hash table.
- * @param board Bitboard.
- * @param data Output hash data.
- * @return True the board was found, false otherwise.
- */
-bool hash_get_from_board(HashTable *hash_table, const Board *board, HashData *data)
-{
-	return hash_get(hash_table, board, board_get_hash_code(board), data);
-}
-
 /**
  * @brief Erase an hash table entry.
  *
@@ -656,7 +962,7 @@ void hash_exclude_move(HashTable *hash_table, const Board *board, const unsigned
 	for (i = 0; i < HASH_N_WAY; ++i) {
 		if (board_equal(&hash->board, board)) {
 			lock = hash_table->lock + (hash_code & hash_table->lock_mask);
-			spin_lock(lock);
+			hash_lock(lock);
 			if (board_equal(&hash->board, board)) {
 				if (hash->data.move[0] == move) {
 					hash->data.move[0] = hash->data.move[1];
@@ -673,6 +979,21 @@ void hash_exclude_move(HashTable *hash_table, const Board *board, const unsigned
 	}
 }
 
+#endif
+
+/**
+ * @brief Find an hash table entry from the board.
+ *
+ * @param hash_table Hash table.
+ * @param board Bitboard.
+ * @param data Output hash data.
+ * @return True the board was found, false otherwise.
+ */
+bool hash_get_from_board(HashTable *hash_table, const Board *board, HashData *data)
+{
+	return hash_get(hash_table, board, board_get_hash_code(board), data);
+}
+
 /**
  * @brief Copy an hastable to another one.
  *
@@ -692,6 +1013,259 @@ void hash_copy(const HashTable *src, HashTable *dest)
 	dest->date = src->date;
 }
 
+/**
+ * @brief Sample the hash table entries.
+ *
+ * The sampled entries are evenly spread over the whole table, so that the
+ * report is cheap enough to be made during a search.
+ *
+ * @param hash_table Hash table.
+ * @param report Output report.
+ * @param n_sample Number of entries to sample.
+ */
+void hash_report(const HashTable *hash_table, HashReport *report, const int n_sample)
+{
+	const unsigned long long n = hash_table->hash_mask + HASH_N_WAY + 1;
+	unsigned long long i, step;
+	int age[4] = {0, 0, 0, 0}, depth[7] = {0, 0, 0, 0, 0, 0, 0};
+	int j, a, n_used = 0, n_full = 0;
+	const Hash *hash;
+	HashData data;
+
+	step = n / n_sample; if (step == 0) step = 1;
+	report->n_sample = 0;
+	for (i = 0; i < n && report->n_sample < n_sample; i += step, ++report->n_sample) {
+		hash = hash_table->hash + i;
+		if (!hash_entry_used(hash)) continue;
+		data = hash_entry_data(hash);
+		++n_used;
+		a = hash_table->date - data.wl.c.date;
+		if (a <= 0) ++n_full;
+		++age[MIN(MAX(a, 0), 3)];
+		++depth[MIN(data.wl.c.depth / 10, 6)];
+	}
+
+	report->occupancy = report->n_sample ? 1000 * n_used / report->n_sample : 0;
+	report->full = report->n_sample ? 1000 * n_full / report->n_sample : 0;
+	for (j = 0; j < 4; ++j) report->age[j] = n_used ? 1000 * age[j] / n_used : 0;
+	for (j = 0; j < 7; ++j) report->depth[j] = n_used ? 1000 * depth[j] / n_used : 0;
+	report->n_overwrite = report->n_collision = 0;	// counted by the searches
+	report->n_contention = 0;
+	for (j = 0; j < hash_table->n_lock; ++j) report->n_contention += hash_table->lock[j].n_contention;
+}
+
+/**
+ * @brief Print an hash table report.
+ *
+ * @param report Hash table report.
+ * @param name Name of the hash table.
+ * @param f Output stream.
+ */
+void hash_report_print(const HashReport *report, const char *name, FILE *f)
+{
+	fprintf(f, "%s: %d samples, occupancy %5.1f%%, full %5.1f%%\n", name, report->n_sample, 0.1 * report->occupancy, 0.1 * report->full);
+	fprintf(f, "  age:   0: %5.1f%%  1: %5.1f%%  2: %5.1f%%  3+: %5.1f%%\n", 0.1 * report->age[0], 0.1 * report->age[1], 0.1 * report->age[2], 0.1 * report->age[3]);
+	fprintf(f, "  depth: 0-9: %5.1f%%  10-19: %5.1f%%  20-29: %5.1f%%  30-39: %5.1f%%  40-49: %5.1f%%  50-59: %5.1f%%  60: %5.1f%%\n",
+		0.1 * report->depth[0], 0.1 * report->depth[1], 0.1 * report->depth[2], 0.1 * report->depth[3], 0.1 * report->depth[4], 0.1 * report->depth[5], 0.1 * report->depth[6]);
+	fprintf(f, "  overwrites: %llu   collisions: %llu   lock contentions: %llu\n", report->n_overwrite, report->n_collision, report->n_contention);
+}
+
+/**
+ * @brief Get how full is the hash table.
+ *
+ * @param hash_table Hash table.
+ * @return Entries of the current date, in permille.
+ */
+int hash_full(const HashTable *hash_table)
+{
+	HashReport report;
+
+	hash_report(hash_table, &report, 1000);
+	return report.full;
+}
+
+/**
+ * @brief Date a loaded entry.
+ *
+ * Entries as recent as the saved table get date 2, older ones date 1, so that
+ * they keep their relative age whatever the date of the loading table.
+ *
+ * @param hash Hash Entry.
+ * @param date Date of the saved table.
+ */
+static void hash_entry_redate(Hash *hash, const int date)
+{
+	HashData data = hash_entry_data(hash);
+
+	if (data.wl.c.date) {
+		data.wl.c.date = (data.wl.c.date >= date) ? 2 : 1;
+		hash_entry_set_data(hash, &data);
+	}
+}
+
+#if USE_HASH_LOCKLESS != 2
+/**
+ * @brief Insert a loaded entry into the hash table.
+ *
+ * The entry replaces an entry of the same position, or the lowest level entry
+ * of its bucket.
+ *
+ * @param hash_table Hash table.
+ * @param entry Hash entry.
+ * @param hash_code Hash code of the entry.
+ */
+static void hash_insert(HashTable *hash_table, const Hash *entry, const unsigned long long hash_code)
+{
+	int i;
+	Hash *hash, *worst;
+	HashData data, worst_data;
+
+	worst = hash = hash_table->hash + (hash_code & hash_table->hash_mask);
+	worst_data = hash_entry_data(worst);
+	if (hash_entry_code(hash) != hash_code) {
+		for (i = 1; i < HASH_N_WAY; ++i) {
+			++hash;
+			if (hash_entry_code(hash) == hash_code) {
+				worst = hash;
+				break;
+			}
+			data = hash_entry_data(hash);
+			if (writeable_level(&worst_data) > writeable_level(&data)) {
+				worst = hash;
+				worst_data = data;
+			}
+		}
+	}
+	*worst = *entry;
+}
+#endif
+
+/** size of the header of an hash table image, so that the entries are page aligned */
+#define HASH_IMAGE_HEADER_SIZE 4096
+
+/**
+ * @brief Save an hash table image.
+ *
+ * The image is made of a header, padded to HASH_IMAGE_HEADER_SIZE bytes, then
+ * of the raw entries, padded to a multiple of HASH_IMAGE_HEADER_SIZE bytes, so
+ * that several images can be saved in the same file, and each one can be
+ * mapped in memory.
+ *
+ * @param hash_table Hash table to save.
+ * @param f Output stream.
+ * @return true if the image is saved, false otherwise.
+ */
+bool hash_save(const HashTable *hash_table, FILE *f)
+{
+	const unsigned int header_edax = EDAX, header_hash = HASH, entry_size = sizeof (Hash);
+	const unsigned char header_version = VERSION, header_release = RELEASE, n_way = HASH_N_WAY, lockless = USE_HASH_LOCKLESS;
+	const unsigned long long n = hash_table->hash_mask + HASH_N_WAY + 1;
+	static const char zero[HASH_IMAGE_HEADER_SIZE];
+	size_t r, pad;
+
+	assert(hash_table != NULL && hash_table->hash != NULL);
+
+	r = fwrite(&header_edax, sizeof (unsigned int), 1, f);
+	r += fwrite(&header_hash, sizeof (unsigned int), 1, f);
+	r += fwrite(&header_version, 1, 1, f);
+	r += fwrite(&header_release, 1, 1, f);
+	r += fwrite(&n_way, 1, 1, f);
+	r += fwrite(&lockless, 1, 1, f);
+	r += fwrite(&entry_size, sizeof (unsigned int), 1, f);
+	r += fwrite(&n, sizeof (unsigned long long), 1, f);
+	r += fwrite(&hash_table->date, 1, 1, f);
+	pad = HASH_IMAGE_HEADER_SIZE - 3 * sizeof (unsigned int) - sizeof (unsigned long long) - 5;
+	r += fwrite(zero, 1, pad, f);
+	if (r != 9 + pad) return false;
+
+	if (fwrite((const void *) hash_table->hash, sizeof (Hash), n, f) != n) return false;
+	pad = (-(n * sizeof (Hash))) & (HASH_IMAGE_HEADER_SIZE - 1);
+	if (fwrite(zero, 1, pad, f) != pad) return false;
+
+	info("<hash save: %llu entries, date = %d>\n", n, hash_table->date);
+
+	return true;
+}
+
+/**
+ * @brief Load an hash table image.
+ *
+ * If the image has the same size than the hash table, it is directly read
+ * into the table, otherwise its entries are inserted one by one (compact
+ * entries, which do not record their whole hash code, cannot). The loaded
+ * entries are then dated as old (date 1) or recent (date 2) entries, and the
+ * table is marked as warm, so that the next search_cleanup() keeps them.
+ *
+ * @param hash_table Hash table to load.
+ * @param f Input stream.
+ * @return true if the image is loaded, false otherwise.
+ */
+bool hash_load(HashTable *hash_table, FILE *f)
+{
+	unsigned int header_edax, header_hash, entry_size;
+	unsigned char header_version, header_release, n_way, lockless, date;
+	unsigned long long n, i;
+	const unsigned long long n_table = hash_table->hash_mask + HASH_N_WAY + 1;
+	size_t r, pad;
+
+	assert(hash_table != NULL && hash_table->hash != NULL);
+
+	r = fread(&header_edax, sizeof (unsigned int), 1, f);
+	r += fread(&header_hash, sizeof (unsigned int), 1, f);
+	r += fread(&header_version, 1, 1, f);
+	r += fread(&header_release, 1, 1, f);
+	r += fread(&n_way, 1, 1, f);
+	r += fread(&lockless, 1, 1, f);
+	r += fread(&entry_size, sizeof (unsigned int), 1, f);
+	r += fread(&n, sizeof (unsigned long long), 1, f);
+	r += fread(&date, 1, 1, f);
+	if (r != 9 || header_edax != EDAX || header_hash != HASH) {
+		warn("hash load: not an Edax hash table image\n");
+		return false;
+	}
+	if (header_version != VERSION || header_release != RELEASE || n_way != HASH_N_WAY || lockless != USE_HASH_LOCKLESS || entry_size != sizeof (Hash)) {
+		warn("hash load: incompatible hash table image (version %d.%d, %d-way, %u-byte entries)\n", header_version, header_release, n_way, entry_size);
+		return false;
+	}
+	pad = HASH_IMAGE_HEADER_SIZE - 3 * sizeof (unsigned int) - sizeof (unsigned long long) - 5;
+	if (fseek(f, pad, SEEK_CUR) != 0) return false;
+
+	if (n == n_table) {
+		if (fread((void *) hash_table->hash, sizeof (Hash), n, f) != n) return false;
+		for (i = 0; i < n; ++i) hash_entry_redate(hash_table->hash + i, date);
+	} else {
+#if USE_HASH_LOCKLESS == 2
+		warn("hash load: cannot resize a compact hash table image (%llu entries instead of %llu)\n", n, n_table);
+		return false;
+#else
+		unsigned long long j, n_read, hash_code;
+		Hash buffer[1024];
+
+		info("<hash load: resizing %llu entries to %llu entries>\n", n, n_table);
+		for (i = 0; i < n; i += n_read) {
+			n_read = MIN(n - i, sizeof buffer / sizeof buffer[0]);
+			if (fread(buffer, sizeof (Hash), n_read, f) != n_read) return false;
+			for (j = 0; j < n_read; ++j) {
+				hash_code = hash_entry_code(buffer + j);
+				if (hash_code) {
+					hash_entry_redate(buffer + j, date);
+					hash_insert(hash_table, buffer + j, hash_code);
+				}
+			}
+		}
+#endif
+	}
+	pad = (-(n * sizeof (Hash))) & (HASH_IMAGE_HEADER_SIZE - 1);
+	if (pad && fseek(f, pad, SEEK_CUR) != 0) return false;
+
+	if (hash_table->date < 2) hash_table->date = 2;
+	hash_table->warm = true;
+
+	info("<hash load: %llu entries, date = %d>\n", n, hash_table->date);
+
+	return true;
+}
+
 /**
  * @brief print HashData content.
  *
@@ -52,21 +52,45 @@ typedef struct HashData {
 	unsigned char move[2];    /*!< best moves */
 } HashData;
 
+/** Latest date of a hash table before it is cleaned up (6 bits in a compact lockless item) */
+#if USE_HASH_LOCKLESS == 2
+#define HASH_DATE_MAX 63
+#else
+#define HASH_DATE_MAX 127
+#endif
+
+#if USE_HASH_LOCKLESS == 2
+/** Hash  : compact lockless item stored in the hash table */
+typedef struct Hash {
+	HASH_COLLISIONS(Board board;)
+	volatile unsigned long long word; /*!< key (mixed hash code high bits) & packed HashData */
+} Hash;
+#elif USE_HASH_LOCKLESS
+/** Hash  : lockless item stored in the hash table */
+typedef struct Hash {
+	HASH_COLLISIONS(Board board;)
+	volatile unsigned long long key;  /*!< hash code xored with data */
+	volatile unsigned long long data; /*!< HashData as a 64 bit word */
+} Hash;
+#else
 /** Hash  : item stored in the hash table */
 typedef struct Hash {
 	HASH_COLLISIONS(unsigned long long key;)
 	Board board;
 	HashData data;
 } Hash;
+#endif
 
 /** HashLock : lock for table entries */
 typedef struct HashLock {
 	SpinLock spin;
+	unsigned int n_contention;    /*!< number of times the lock was already taken */
 } HashLock;
 
 /** HashTable: position storage */
 typedef struct HashTable {
 	void *memory;                 /*!< allocated memory */
+	size_t memory_mapped;         /*!< size of the memory mapping (0 if allocated by malloc) */
 	Hash *hash;                   /*!< hash table */
 	HashLock *lock;               /*!< table with locks */
 	unsigned long long hash_mask; /*!< a bit mask for hash entries */
@@ -74,8 +98,31 @@ typedef struct HashTable {
 	int n_hash;                   /*!< hash table size */
 	int n_lock;                   /*!< number of locks */
 	unsigned char date;           /*!< date */
+	bool shared;                  /*!< shared with other processes */
+	volatile unsigned char *shared_date; /*!< latest date of the processes sharing the table */
+	char *shared_name;            /*!< shared memory to remove when freed, by the process that created it */
+	bool warm;                    /*!< loaded from an image or fed from the book: dated instead of cleared */
+	struct HashCount *count;      /*!< replacement counters of the search using this copy of the table (or NULL) */
 } HashTable;
 
+/** HashCount: replacement counters of a search thread on a hash table */
+typedef struct HashCount {
+	unsigned long long n_overwrite; /*!< new entries replacing another position */
+	unsigned long long n_collision; /*!< new entries replacing another position of the current date */
+} HashCount;
+
+/** HashReport: hash table telemetry, from a sample of entries */
+typedef struct HashReport {
+	int n_sample;                 /*!< number of sampled entries */
+	int occupancy;                /*!< used entries (permille) */
+	int full;                     /*!< entries of the current date (permille) */
+	int age[4];                   /*!< used entries aged 0, 1, 2 & 3+ dates (permille of used entries) */
+	int depth[7];                 /*!< used entries of depth 0-9, 10-19, ... 60 (permille of used entries) */
+	unsigned long long n_overwrite; /*!< new entries replacing another position (set by the search) */
+	unsigned long long n_collision; /*!< new entries replacing another position of the current date (set by the search) */
+	unsigned long long n_contention; /*!< lock contentions */
+} HashReport;
+
 /** HashStoreData : data to store */
 typedef struct HashStoreData {
 	HashData data;
@@ -89,6 +136,7 @@ typedef struct HashStoreData {
 
 void hash_move_init(void);
 void hash_init(HashTable*, const unsigned long long);
+void hash_init_shared(HashTable*, const unsigned long long, const char*);
 void hash_cleanup(HashTable*);
 void hash_clear(HashTable*);
 void hash_free(HashTable*);
@@ -99,7 +147,12 @@ bool hash_get(HashTable*, const Board *, const unsigned long long, HashData *);
 bool hash_get_from_board(HashTable*, const Board *, HashData *);
 void hash_exclude_move(HashTable*, const Board *, const unsigned long long, const int);
 void hash_copy(const HashTable*, HashTable*);
+bool hash_save(const HashTable*, FILE*);
+bool hash_load(HashTable*, FILE*);
 void hash_print(const HashData*, FILE*);
+void hash_report(const HashTable*, HashReport*, const int);
+void hash_report_print(const HashReport*, const char*, FILE*);
+int hash_full(const HashTable*);
 extern unsigned int writeable_level(HashData *data);
 
 extern const HashData HASH_DATA_INIT;
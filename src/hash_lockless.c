@@ -0,0 +1,732 @@
+/**
+ * @file hash_lockless.c
+ *
+ * @brief Lockless transposition table.
+ *
+ * Each entry is made of two 64-bit words: the hash data, and the hash code
+ * xored with the hash data (Hyatt & Mann's lockless hashing). An entry is
+ * valid only if the xor of both words gives back the searched hash code, so
+ * that an entry torn by concurrent writes is simply not found, and no lock is
+ * ever needed, neither to probe nor to store.
+ * An entry is 16 bytes long, so that a 4-way bucket fits a 64-byte cache line.
+ * As the board is not stored any more, the identity of a position relies on
+ * its 64-bit hash code only. With HASH_COLLISIONS, the board is kept to count
+ * the false hits.
+ *
+ * With USE_HASH_LOCKLESS == 2, an entry is a single 64-bit word made of a
+ * 23-bit key and of the packed hash data, written at once. The key mixes the
+ * high bits of both halves of the hash code, so that it depends on both
+ * bitboards. With the bucket index, 23 + log2(buckets) bits of the hash code
+ * are verified, e.g. 43 bits for the default 2^22 entries table, which then
+ * holds three times more positions than the locked table in the same memory.
+ *
+ * This file is included by hash.c when USE_HASH_LOCKLESS is set.
+ *
+ * @date 1998 - 2026
+ * @author Richard Delorme
+ * @author Toshihiko Okuhara
+ * @version 4.5
+ */
+
+/** HashWord : HashData seen as a 64-bit word */
+typedef union HashWord {
+	HashData data;
+	unsigned long long ull;
+} HashWord;
+
+#if USE_HASH_LOCKLESS == 2
+
+/** Bit position of the key in a compact entry */
+#define HASH_KEY_SHIFT 41
+
+/**
+ * @brief Get the key of a compact entry from a hash code.
+ *
+ * The high bits of the hash code come from the player bitboard only: they are
+ * mixed with the high bits of its low half, that depend on both bitboards.
+ *
+ * @param hash_code Hash code.
+ * @return The key, in the high bits of the entry.
+ */
+static inline unsigned long long hash_key(const unsigned long long hash_code)
+{
+	return ((hash_code ^ (hash_code << 32)) >> HASH_KEY_SHIFT) << HASH_KEY_SHIFT;
+}
+
+/**
+ * @brief Pack hash data into the 41 low bits of a compact entry.
+ *
+ * Layout: depth (6 bits), selectivity (3), date (6), lower + 64 (8),
+ * 64 - upper (8), best move ^ NOMOVE (7), cost / 4 (3). All-zero bits unpack
+ * to HASH_DATA_INIT, so that an empty entry never gives a cutoff.
+ * The second best move is not stored.
+ *
+ * @param data Hash data.
+ * @return Packed data.
+ */
+static inline unsigned long long hash_pack(const HashData *data)
+{
+	assert(data->wl.c.date <= HASH_DATE_MAX);
+
+	return data->wl.c.depth
+		| ((unsigned long long) data->wl.c.selectivity << 6)
+		| ((unsigned long long) data->wl.c.date << 9)
+		| ((unsigned long long) (data->lower + 64) << 15)
+		| ((unsigned long long) (64 - data->upper) << 23)
+		| ((unsigned long long) (data->move[0] ^ NOMOVE) << 31)
+		| ((unsigned long long) MIN((data->wl.c.cost + 3) >> 2, 7) << 38);
+}
+
+/**
+ * @brief Unpack hash data from a compact entry.
+ *
+ * @param x Compact entry.
+ * @param w Output hash data.
+ */
+static inline void hash_unpack(const unsigned long long x, HashWord *w)
+{
+	w->data.wl.c.depth = x & 0x3f;
+	w->data.wl.c.selectivity = (x >> 6) & 0x7;
+	w->data.wl.c.cost = ((x >> 38) & 0x7) << 2;
+	w->data.wl.c.date = (x >> 9) & 0x3f;
+	w->data.lower = (signed char) ((int) ((x >> 15) & 0xff) - 64);
+	w->data.upper = (signed char) (64 - (int) ((x >> 23) & 0xff));
+	w->data.move[0] = ((x >> 31) & 0x7f) ^ NOMOVE;
+	w->data.move[1] = NOMOVE;
+}
+
+/**
+ * @brief Clear a slice of the hashtable.
+ *
+ * Set the hash table entries to zero, that is an empty entry.
+ * @param pHash First entry to clear.
+ * @param n Number of entries to clear.
+ */
+static void hash_cleanup_slice(Hash *pHash, const unsigned long long n)
+{
+	unsigned long long i;
+
+	for (i = 0; i < n; ++i, ++pHash) {
+		HASH_COLLISIONS(pHash->board.player = pHash->board.opponent = 0;)
+		pHash->word = 0;
+	}
+}
+
+/**
+ * @brief Read an hash entry.
+ *
+ * The entry is read in a single 64-bit word, then its key is checked against
+ * the key of the hash code. An empty entry, all bits zero, is never found, even
+ * for a hash code of key 0, as a stored entry has a non-zero date.
+ *
+ * @param hash Hash Entry.
+ * @param hash_code Hash code.
+ * @param w Output hash data.
+ * @return true if the entry matches the hash code.
+ */
+static inline bool hash_read(const Hash *hash, const unsigned long long hash_code, HashWord *w)
+{
+	const unsigned long long x = hash->word;
+
+	if (x == 0 || (x ^ hash_key(hash_code)) >> HASH_KEY_SHIFT) return false;
+	hash_unpack(x, w);
+	return true;
+}
+
+/**
+ * @brief Write an hash entry.
+ *
+ * @param hash Hash Entry.
+ * @param hash_code Hash code.
+ * @param w Hash data.
+ */
+static inline void hash_write(Hash *hash, const unsigned long long hash_code, const HashWord *w)
+{
+	hash->word = hash_key(hash_code) | hash_pack(&w->data);
+}
+
+/**
+ * @brief Check if an hash entry is used.
+ *
+ * @param hash Hash Entry.
+ * @return true if the entry is used.
+ */
+static inline bool hash_entry_used(const Hash *hash)
+{
+	return hash->word != 0;
+}
+
+/**
+ * @brief Get the data of an hash entry.
+ *
+ * @param hash Hash Entry.
+ * @return The hash data.
+ */
+static inline HashData hash_entry_data(const Hash *hash)
+{
+	HashWord w;
+
+	hash_unpack(hash->word, &w);
+	return w.data;
+}
+
+/**
+ * @brief Change the data of an hash entry.
+ *
+ * @param hash Hash Entry.
+ * @param data New hash data.
+ */
+static inline void hash_entry_set_data(Hash *hash, const HashData *data)
+{
+	hash->word = ((hash->word >> HASH_KEY_SHIFT) << HASH_KEY_SHIFT) | hash_pack(data);
+}
+
+/**
+ * @brief Copy an hash entry into another entry of the same bucket.
+ *
+ * @param dest Destination entry.
+ * @param src Source entry.
+ */
+static inline void hash_entry_copy(Hash *dest, const Hash *src)
+{
+	HASH_COLLISIONS(dest->board = src->board;)
+	dest->word = src->word;
+}
+
+#else
+
+/**
+ * @brief Clear a slice of the hashtable.
+ *
+ * Set the hash table entries to an empty, unmatchable, state
+ * (hash code ^ data == 0).
+ * @param pHash First entry to clear.
+ * @param n Number of entries to clear.
+ */
+static void hash_cleanup_slice(Hash *pHash, const unsigned long long n)
+{
+	unsigned long long i;
+	HashWord init;
+
+	assert(sizeof (HashData) == sizeof (unsigned long long));
+
+	init.data = HASH_DATA_INIT;
+	for (i = 0; i < n; ++i, ++pHash) {
+		HASH_COLLISIONS(pHash->board.player = pHash->board.opponent = 0;)
+		pHash->key = init.ull;
+		pHash->data = init.ull;
+	}
+}
+
+/**
+ * @brief Read an hash entry.
+ *
+ * The data word is read first, then checked against the key word.
+ * An empty entry decodes to a null hash code: a null hash code is thus never
+ * found, as it would match every empty entry.
+ *
+ * @param hash Hash Entry.
+ * @param hash_code Hash code.
+ * @param w Output hash data.
+ * @return true if the entry matches the hash code.
+ */
+static inline bool hash_read(const Hash *hash, const unsigned long long hash_code, HashWord *w)
+{
+	w->ull = hash->data;
+	return (hash->key ^ w->ull) == hash_code && hash_code != 0;
+}
+
+/**
+ * @brief Write an hash entry.
+ *
+ * @param hash Hash Entry.
+ * @param hash_code Hash code.
+ * @param w Hash data.
+ */
+static inline void hash_write(Hash *hash, const unsigned long long hash_code, const HashWord *w)
+{
+	hash->key = hash_code ^ w->ull;
+	hash->data = w->ull;
+}
+
+/**
+ * @brief Get the hash code of an hash entry.
+ *
+ * @param hash Hash Entry.
+ * @return The hash code, or 0 for an empty entry.
+ */
+static inline unsigned long long hash_entry_code(const Hash *hash)
+{
+	return hash->key ^ hash->data;
+}
+
+/**
+ * @brief Check if an hash entry is used.
+ *
+ * @param hash Hash Entry.
+ * @return true if the entry is used.
+ */
+static inline bool hash_entry_used(const Hash *hash)
+{
+	return hash_entry_code(hash) != 0;
+}
+
+/**
+ * @brief Get the data of an hash entry.
+ *
+ * @param hash Hash Entry.
+ * @return The hash data.
+ */
+static inline HashData hash_entry_data(const Hash *hash)
+{
+	HashWord w;
+
+	w.ull = hash->data;
+	return w.data;
+}
+
+/**
+ * @brief Change the data of an hash entry.
+ *
+ * @param hash Hash Entry.
+ * @param data New hash data.
+ */
+static inline void hash_entry_set_data(Hash *hash, const HashData *data)
+{
+	HashWord w;
+
+	w.data = *data;
+	hash_write(hash, hash_entry_code(hash), &w);
+}
+
+/**
+ * @brief Copy an hash entry into another entry of the same bucket.
+ *
+ * A torn copy does not match any hash code.
+ *
+ * @param dest Destination entry.
+ * @param src Source entry.
+ */
+static inline void hash_entry_copy(Hash *dest, const Hash *src)
+{
+	HASH_COLLISIONS(dest->board = src->board;)
+	dest->key = src->key;
+	dest->data = src->data;
+}
+
+#endif
+
+/**
+ * @brief Get the level of an hash entry.
+ *
+ * @param hash Hash Entry.
+ * @return A level.
+ */
+static inline unsigned int hash_level(const Hash *hash)
+{
+	HashData data = hash_entry_data(hash);
+
+	return writeable_level(&data);
+}
+
+/**
+ * @brief Count the replacement of another position.
+ *
+ * The counters belong to the search thread using this copy of the table.
+ *
+ * @param hash_table Hash table.
+ * @param hash Replaced entry.
+ */
+static inline void hash_count_overwrite(HashTable *hash_table, const Hash *hash)
+{
+	HashCount *count = hash_table->count;
+
+	if (count && hash_entry_used(hash)) {
+		++count->n_overwrite;
+		if (hash_entry_data(hash).wl.c.date == hash_table->date) ++count->n_collision;
+	}
+}
+
+/**
+ * @brief Initialize a new hash table item.
+ *
+ * @param hash Hash Entry.
+ * @param demote Entry receiving the previous content of the hash entry, or NULL.
+ * @param board Bitboard.
+ * @param hash_code Hash code.
+ * @param storedata.data.date Hash date.
+ * @param storedata.data.depth Search depth.
+ * @param storedata.data.selectivity Search selectivity.
+ * @param storedata.data.cost Search cost.
+ * @param storedata.alpha Alpha bound.
+ * @param storedata.beta Beta bound.
+ * @param storedata.score Best score.
+ * @param storedata.move Best move.
+ */
+static void hash_new(Hash *hash, Hash *demote, const Board *board, const unsigned long long hash_code, HashStoreData *storedata)
+{
+	HashWord w;
+
+	if (demote) hash_entry_copy(demote, hash);
+	HASH_STATS(if (hash_entry_data(hash).wl.c.date == storedata->data.wl.c.date) ++statistics.n_hash_remove;)
+	HASH_STATS(++statistics.n_hash_new;)
+	HASH_COLLISIONS(hash->board = *board;)
+	(void) board;
+	data_new(&w.data, storedata);
+	hash_write(hash, hash_code, &w);
+}
+
+/**
+ * @brief Set a new hash table item.
+ *
+ * @param hash Hash Entry.
+ * @param demote Entry receiving the previous content of the hash entry, or NULL.
+ * @param board Bitboard.
+ * @param hash_code Hash code.
+ * @param storedata.data.date Hash date.
+ * @param storedata.data.depth Search depth.
+ * @param storedata.data.selectivity Search selectivity.
+ * @param storedata.data.cost Search cost.
+ * @param storedata.data.lower Lower score bound.
+ * @param storedata.data.upper Upper score bound.
+ * @param storedata.move Best move.
+ */
+static void hash_set(Hash *hash, Hash *demote, const Board *board, const unsigned long long hash_code, HashStoreData *storedata)
+{
+	HashWord w;
+
+	if (demote) hash_entry_copy(demote, hash);
+	storedata->data.move[1] = NOMOVE;
+	HASH_STATS(if (hash_entry_data(hash).wl.c.date == storedata->data.wl.c.date) ++statistics.n_hash_remove;)
+	HASH_STATS(++statistics.n_hash_new;)
+	HASH_COLLISIONS(hash->board = *board;)
+	(void) board;
+	w.data = storedata->data;
+	assert(w.data.upper >= w.data.lower);
+	hash_write(hash, hash_code, &w);
+}
+
+/**
+ * @brief update the hash entry
+ *
+ * The entry is read, updated locally, then written back. A concurrent
+ * update may be lost, but a corrupted entry is never readable.
+ *
+ * @param hash Hash Entry.
+ * @param hash_code Hash code.
+ * @param storedata.data.date Hash date.
+ * @param storedata.data.depth Search depth.
+ * @param storedata.data.selectivity Search selectivity.
+ * @param storedata.data.cost Hash Cost (log2(node count)).
+ * @param storedata.alpha Alpha bound.
+ * @param storedata.beta Beta bound.
+ * @param storedata.score Best score.
+ * @param storedata.move Best move.
+ * @return true if an entry has been updated, false otherwise.
+ */
+static bool hash_update(Hash *hash, const unsigned long long hash_code, HashStoreData *storedata)
+{
+	HashWord w;
+
+	if (!hash_read(hash, hash_code, &w)) return false;
+
+	if (w.data.wl.us.selectivity_depth == storedata->data.wl.us.selectivity_depth)
+		data_update(&w.data, storedata);
+	else	data_upgrade(&w.data, storedata);
+	w.data.wl.c.date = storedata->data.wl.c.date;
+	if (w.data.lower > w.data.upper) { // reset the hash-table...
+		data_new(&w.data, storedata);
+	}
+	hash_write(hash, hash_code, &w);
+	return true;
+}
+
+/**
+ * @brief replace the hash entry.
+ *
+ * @param hash Hash Entry.
+ * @param hash_code Hash code.
+ * @param storedata.data.date Hash date.
+ * @param storedata.data.depth Search depth.
+ * @param storedata.data.selectivity Search selectivity.
+ * @param storedata.data.cost Hash Cost (log2(node count)).
+ * @param storedata.alpha Alpha bound.
+ * @param storedata.beta Beta bound.
+ * @param storedata.score Best score.
+ * @param storedata.move Best move.
+ * @return true if an entry has been replaced, false otherwise.
+ */
+static bool hash_replace(Hash *hash, const unsigned long long hash_code, HashStoreData *storedata)
+{
+	HashWord w;
+
+	if (!hash_read(hash, hash_code, &w)) return false;
+
+	data_new(&w.data, storedata);
+	hash_write(hash, hash_code, &w);
+	return true;
+}
+
+/**
+ * @brief Reset an hash entry from new data values.
+ *
+ * @param hash Hash Entry.
+ * @param hash_code Hash code.
+ * @param storedata.data.date Hash date.
+ * @param storedata.data.depth Search depth.
+ * @param storedata.data.selectivity Search selectivity.
+ * @param storedata.data.lower Lower score bound.
+ * @param storedata.data.upper Upper score bound.
+ * @param storedata.move Best move.
+ * @return true if an entry has been reset, false otherwise.
+ */
+static bool hash_reset(Hash *hash, const unsigned long long hash_code, HashStoreData *storedata)
+{
+	HashWord w;
+
+	if (!hash_read(hash, hash_code, &w)) return false;
+
+	if (w.data.wl.us.selectivity_depth == storedata->data.wl.us.selectivity_depth) {
+		if (w.data.lower < storedata->data.lower) w.data.lower = storedata->data.lower;
+		if (w.data.upper > storedata->data.upper) w.data.upper = storedata->data.upper;
+	} else {
+		w.data.lower = storedata->data.lower;
+		w.data.upper = storedata->data.upper;
+	}
+	w.data.wl = storedata->data.wl;
+	if (storedata->data.move[0] != NOMOVE) {
+		w.data.move[1] = w.data.move[0];
+		w.data.move[0] = storedata->data.move[0];
+	}
+	hash_write(hash, hash_code, &w);
+	return true;
+}
+
+/**
+ * @brief Choose the entry to replace with the split policy.
+ *
+ * Same as the locked hash_split_victim(). The first entry is moved down by
+ * copying it just before the insertion.
+ *
+ * @param bucket First way of the bucket.
+ * @param data New data.
+ * @param demote Output entry receiving the previous first entry, or NULL.
+ * @return The entry to replace.
+ */
+static Hash* hash_split_victim(Hash *bucket, HashData *data, Hash **demote)
+{
+	Hash *worst, *hash;
+	HashData first;
+	int i;
+
+	*demote = NULL;
+	if (HASH_N_WAY < 2) return bucket;
+
+	worst = hash = bucket + 1;
+	for (i = 2; i < HASH_N_WAY; ++i) {
+		++hash;
+		if (hash_level(worst) > hash_level(hash)) {
+			worst = hash;
+		}
+	}
+
+	if (!hash_entry_used(bucket)) return bucket;
+	first = hash_entry_data(bucket);
+	if (preferred_level(data) >= preferred_level(&first)) {
+		*demote = worst;
+		HASH_STATS(++statistics.n_hash_demote;)
+		return bucket;
+	}
+	return worst;
+}
+
+/**
+ * @brief feed hash table (from Cassio).
+ *
+ * @param hash_table Hash Table.
+ * @param board Bitboard.
+ * @param hash_code Hash code of an othello board.
+ * @param storedata.data.depth Search depth.
+ * @param storedata.data.selectivity Selectivity level.
+ * @param storedata.data.lower Alpha bound.
+ * @param storedata.data.upper Beta bound.
+ * @param storedata.move best move.
+ */
+void hash_feed(HashTable *hash_table, const Board *board, const unsigned long long hash_code, HashStoreData *storedata)
+{
+	Hash *hash, *worst, *demote = NULL;
+	int i;
+
+	storedata->data.wl.c.date = hash_table->date ? hash_table->date : 1;
+	storedata->data.wl.c.cost = 0;
+
+	worst = hash = hash_table->hash + (hash_code & hash_table->hash_mask);
+	if (hash_reset(hash, hash_code, storedata)) return;
+
+	for (i = 1; i < HASH_N_WAY; ++i) {
+		++hash;
+		if (hash_reset(hash, hash_code, storedata)) return;
+		if (hash_level(worst) > hash_level(hash)) {
+			worst = hash;
+		}
+	}
+
+	// new entry
+	if (options.hash_policy == HASH_POLICY_SPLIT) worst = hash_split_victim(hash_table->hash + (hash_code & hash_table->hash_mask), &storedata->data, &demote);
+	hash_count_overwrite(hash_table, demote ? demote : worst);
+	hash_set(worst, demote, board, hash_code, storedata);
+}
+
+/**
+ * @brief Store an hashtable item
+ *
+ * Same as the locked hash_store(): update the entry if it already exists,
+ * otherwise replace the entry chosen by the replacement policy.
+ *
+ * @param hash_table Hash table to update.
+ * @param board Bitboard.
+ * @param hash_code  Hash code of an othello board.
+ * @param storedata.data.depth      Search depth.
+ * @param storedata.data.selectivity   Search selectivity.
+ * @param storedata.data.cost       Search cost (i.e. log2(node count)).
+ * @param storedata.alpha      Alpha bound when calling the alphabeta function.
+ * @param storedata.beta       Beta bound when calling the alphabeta function.
+ * @param storedata.score      Best score found.
+ * @param storedata.move       Best move found.
+ */
+void hash_store(HashTable *hash_table, const Board *board, const unsigned long long hash_code, HashStoreData *storedata)
+{
+	int i;
+	Hash *worst, *hash, *demote = NULL;
+
+	worst = hash = hash_table->hash + (hash_code & hash_table->hash_mask);
+	storedata->data.wl.c.date = hash_table->date;
+	if (hash_update(hash, hash_code, storedata)) return;
+
+	for (i = 1; i < HASH_N_WAY; ++i) {
+		++hash;
+		if (hash_update(hash, hash_code, storedata)) return;
+		if (hash_level(worst) > hash_level(hash)) {
+			worst = hash;
+		}
+	}
+
+	if (options.hash_policy == HASH_POLICY_SPLIT) worst = hash_split_victim(hash_table->hash + (hash_code & hash_table->hash_mask), &storedata->data, &demote);
+	hash_count_overwrite(hash_table, demote ? demote : worst);
+	hash_new(worst, demote, board, hash_code, storedata);
+}
+
+/**
+ * @brief Store an hashtable item.
+ *
+ * Does the same as hash_store() except it always store the current search state
+ *
+ * @param hash_table Hash table to update.
+ * @param board Bitboard.
+ * @param hash_code  Hash code of an othello board.
+ * @param storedata.data.depth      Search depth.
+ * @param storedata.data.selectivity   Search selectivity.
+ * @param storedata.data.cost       Search cost (i.e. log2(node count)).
+ * @param storedata.alpha      Alpha bound when calling the alphabeta function.
+ * @param storedata.beta       Beta bound when calling the alphabeta function.
+ * @param storedata.score      Best score found.
+ * @param storedata.move       Best move found.
+ */
+void hash_force(HashTable *hash_table, const Board *board, const unsigned long long hash_code, HashStoreData *storedata)
+{
+	int i;
+	Hash *worst, *hash, *demote = NULL;
+
+	worst = hash = hash_table->hash + (hash_code & hash_table->hash_mask);
+	storedata->data.wl.c.date = hash_table->date;
+	if (hash_replace(hash, hash_code, storedata)) return;
+
+	for (i = 1; i < HASH_N_WAY; ++i) {
+		++hash;
+		if (hash_replace(hash, hash_code, storedata)) return;
+		if (hash_level(worst) > hash_level(hash)) {
+			worst = hash;
+		}
+	}
+
+	if (options.hash_policy == HASH_POLICY_SPLIT) worst = hash_split_victim(hash_table->hash + (hash_code & hash_table->hash_mask), &storedata->data, &demote);
+	hash_count_overwrite(hash_table, demote ? demote : worst);
+	hash_new(worst, demote, board, hash_code, storedata);
+}
+
+/**
+ * @brief Find an hash table entry according to the evaluated board hash codes.
+ *
+ * The date of a found entry is refreshed only if it changed, to avoid
+ * dirtying the cache line on every probe.
+ *
+ * @param hash_table Hash table.
+ * @param board Bitboard.
+ * @param hash_code Hash code of an othello board.
+ * @param data Output hash data.
+ * @return True the board was found, false otherwise.
+ */
+bool hash_get(HashTable *hash_table, const Board *board, const unsigned long long hash_code, HashData *data)
+{
+	int i;
+	Hash *hash;
+	HashWord w;
+
+	HASH_STATS(++statistics.n_hash_search;)
+	HASH_COLLISIONS(++statistics.n_hash_n;)
+	(void) board;
+	hash = hash_table->hash + (hash_code & hash_table->hash_mask);
+	for (i = 0; i < HASH_N_WAY; ++i) {
+		if (hash_read(hash, hash_code, &w)) {
+			HASH_COLLISIONS(if (!board_equal(board, &hash->board)) {)
+			HASH_COLLISIONS(	++statistics.n_hash_collision;)
+			HASH_COLLISIONS(	printf("key = %llu\n", hash_code);)
+			HASH_COLLISIONS(	board_print(board, WHITE, stdout);)
+			HASH_COLLISIONS(	board_print(&hash->board, WHITE, stdout);)
+			HASH_COLLISIONS(})
+			HASH_STATS(++statistics.n_hash_found;)
+			HASH_STATS(if (i == 0) ++statistics.n_hash_found_first;)
+			*data = w.data;
+			if (w.data.wl.c.date != hash_table->date) {
+				w.data.wl.c.date = hash_table->date;
+				hash_write(hash, hash_code, &w);
+			}
+			return true;
+		}
+		++hash;
+	}
+	*data = HASH_DATA_INIT;
+	return false;
+}
+
+/**
+ * @brief Erase an hash table entry.
+ *
+ * @param hash_table Hash table.
+ * @param board Bitboard.
+ * @param hash_code Hash code of an othello board.
+ * @param move Move to exclude.
+ */
+void hash_exclude_move(HashTable *hash_table, const Board *board, const unsigned long long hash_code, const int move)
+{
+	int i;
+	Hash *hash;
+	HashWord w;
+
+	(void) board;
+	hash = hash_table->hash + (hash_code & hash_table->hash_mask);
+	for (i = 0; i < HASH_N_WAY; ++i) {
+		if (hash_read(hash, hash_code, &w)) {
+			if (w.data.move[0] == move) {
+				w.data.move[0] = w.data.move[1];
+				w.data.move[1] = NOMOVE;
+			} else if (w.data.move[1] == move) {
+				w.data.move[1] = NOMOVE;
+			}
+			w.data.lower = SCORE_MIN;
+			hash_write(hash, hash_code, &w);
+			return;
+		}
+		++hash;
+	}
+}
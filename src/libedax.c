@@ -0,0 +1,283 @@
+/**
+ * @file libedax.c
+ *
+ * Asynchronous search interface to use Edax as a library.
+ *
+ * An engine owns its search, i.e. its hash tables and its parallel tasks,
+ * and runs each search in its own thread, so that several engines can
+ * search independent positions in the same process. Each engine has its own
+ * configuration (number of tasks, hash table size, parallel search engine,
+ * simulated speed), and the search limits and window of each search are passed
+ * as arguments. The engines share the global data initialized once by
+ * edax_library_init() (tables, evaluation weights), and still read the
+ * remaining process-wide settings (e.g. the probcut & sort tunings, the logs)
+ * from the global options, which they never modify.
+ *
+ * A typical use is:
+ * @code
+ *	EdaxEngine *engine;
+ *	EdaxConfig config;
+ *	EdaxLimits limits;
+ *
+ *	edax_library_init("data/eval.dat");
+ *	edax_config_init(&config);
+ *	config.n_task = 4;
+ *	engine = edax_engine_create(&config);
+ *	edax_limits_init(&limits);
+ *	limits.depth = 20;
+ *	edax_search_async(engine, &board, &limits, my_callback, my_data);
+ *	...
+ *	result = edax_search_wait(engine);
+ *	edax_engine_free(engine);
+ *	edax_library_free();
+ * @endcode
+ *
+ * @date 1998 - 2026
+ * @author Richard Delorme
+ * @author Toshihiko Okuhara
+ * @version 4.5
+ */
+
+#include "libedax.h"
+
+#include "bit.h"
+#include "const.h"
+#include "eval.h"
+#include "options.h"
+#include "stats.h"
+#include "util.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+/** Search engine */
+struct EdaxEngine {
+	Search search;               /**< search (first, for its alignment) */
+	Result result;               /**< result of the last search */
+	int alpha;                   /**< lower bound of the search window */
+	int beta;                    /**< upper bound of the search window */
+	EdaxCallback callback;       /**< call back function at the end of the search (or NULL) */
+	void *data;                  /**< call back user data */
+	Thread thread;               /**< search thread */
+	bool is_running;             /**< flag set while a search thread is not joined */
+};
+
+/**
+ * @brief Initialize the global data of the library.
+ *
+ * Call it once, before creating any engine.
+ *
+ * @param eval_file Evaluation weight file (or NULL for the eval-file option).
+ */
+void edax_library_init(const char *eval_file)
+{
+	if (eval_file == NULL) eval_file = options.eval_file ? options.eval_file : "data/eval.dat";
+
+	cpu_init();
+	bit_init();
+	edge_stability_init();
+	statistics_init();
+	eval_open(eval_file);
+	search_global_init();
+}
+
+/**
+ * @brief Free the global data of the library.
+ *
+ * Call it once, after all the engines have been freed.
+ */
+void edax_library_free(void)
+{
+	eval_close();
+}
+
+/**
+ * @brief Set default search limits.
+ *
+ * Solve the position with the full window, without time limit.
+ *
+ * @param limits Search limits.
+ */
+void edax_limits_init(EdaxLimits *limits)
+{
+	limits->depth = 60;
+	limits->selectivity = NO_SELECTIVITY;
+	limits->time = 0;
+	limits->alpha = SCORE_MIN;
+	limits->beta = SCORE_MAX;
+}
+
+/**
+ * @brief Set a default engine configuration.
+ *
+ * The defaults are those of the global options, with a single task and a
+ * private hash table: the engines never attach to the shared hash table, as
+ * they would share it with each other.
+ *
+ * @param config Engine configuration.
+ */
+void edax_config_init(EdaxConfig *config)
+{
+	search_config_init(config);
+	config->n_task = 1;
+	config->hash_shared_name = NULL;
+}
+
+/**
+ * @brief Create a search engine.
+ *
+ * @param config Engine configuration (or NULL for the default one).
+ * @return A new engine, or NULL if it cannot be allocated.
+ */
+EdaxEngine* edax_engine_create(const EdaxConfig *config)
+{
+	EdaxEngine *engine;
+	EdaxConfig c;
+
+	engine = (EdaxEngine*) mm_malloc(sizeof (EdaxEngine));
+	if (engine == NULL) {
+		warn("Cannot allocate a new engine.\n");
+		return NULL;
+	}
+
+	if (config) c = *config; else edax_config_init(&c);
+	c.n_task = MAX(1, MIN(c.n_task, MAX_THREADS));
+	c.hash_table_size = MAX(10, MIN(c.hash_table_size, sizeof (void*) == 4 ? 25 : 30));
+
+	search_init_config(&engine->search, &c);
+	engine->search.options.verbosity = 0;
+
+	spin_init(&engine->result);
+	engine->result.move = NOMOVE;
+	engine->result.score = -SCORE_INF;
+	engine->result.depth = -1;
+	engine->alpha = SCORE_MIN;
+	engine->beta = SCORE_MAX;
+	engine->callback = NULL;
+	engine->data = NULL;
+	engine->is_running = false;
+
+	return engine;
+}
+
+/**
+ * @brief Free a search engine.
+ *
+ * A running search is cancelled.
+ *
+ * @param engine Engine.
+ */
+void edax_engine_free(EdaxEngine *engine)
+{
+	if (engine) {
+		edax_search_cancel(engine);
+		edax_search_wait(engine);
+		search_free(&engine->search);
+		spin_free(&engine->result);
+		mm_free(engine);
+	}
+}
+
+/**
+ * @brief Search thread.
+ *
+ * @param v Engine cast as void.
+ * @return NULL (unused).
+ */
+static void* edax_search_run(void *v)
+{
+	EdaxEngine *engine = (EdaxEngine*) v;
+	Search *search = &engine->search;
+	SpinLock spin;
+
+	search_run_window(search, engine->alpha, engine->beta);
+
+	spin_lock(&engine->result);
+		spin = engine->result.spin;
+		engine->result = *search->result;
+		engine->result.spin = spin;
+	spin_unlock(&engine->result);
+
+	if (engine->callback) engine->callback(&engine->result, engine->data);
+
+	return NULL;
+}
+
+/**
+ * @brief Start a search.
+ *
+ * The function returns at once, while the search runs in its own thread.
+ * A previous search of the engine is waited for first.
+ * The call back function, if any, is called from the search thread when the
+ * search ends, either completed or cancelled.
+ *
+ * @param engine Engine.
+ * @param board Position to search, seen from the player to move.
+ * @param limits Search limits (or NULL for the default ones).
+ * @param callback Call back function (or NULL).
+ * @param data User data passed to the call back function.
+ * @return true if the search started.
+ */
+bool edax_search_async(EdaxEngine *engine, const Board *board, const EdaxLimits *limits, EdaxCallback callback, void *data)
+{
+	Search *search;
+	EdaxLimits l;
+	int n_empties;
+
+	if (engine == NULL || board == NULL) return false;
+
+	edax_search_wait(engine);
+	search = &engine->search;
+
+	if (limits) l = *limits; else edax_limits_init(&l);
+	n_empties = board_count_empties(board);
+	l.depth = MAX(0, MIN(l.depth, n_empties));
+	l.selectivity = MAX(0, MIN(l.selectivity, NO_SELECTIVITY));
+	l.alpha = MAX(SCORE_MIN, MIN(l.alpha, SCORE_MAX - 1));
+	l.beta = MAX(l.alpha + 1, MIN(l.beta, SCORE_MAX));
+
+	search_set_board(search, board, BLACK);
+	search->options.depth = l.depth;
+	search->options.selectivity = l.selectivity;
+	search_set_move_time(search, l.time > 0 ? l.time : TIME_MAX);
+
+	engine->alpha = l.alpha;
+	engine->beta = l.beta;
+	engine->callback = callback;
+	engine->data = data;
+
+	search->stop = RUNNING;
+	engine->is_running = true;
+	thread_create(&engine->thread, edax_search_run, engine);
+
+	return true;
+}
+
+/**
+ * @brief Cancel the running search, if any.
+ *
+ * The search stops as soon as possible, with the result found so far.
+ *
+ * @param engine Engine.
+ */
+void edax_search_cancel(EdaxEngine *engine)
+{
+	if (engine->is_running) search_stop_all(&engine->search, STOP_ON_DEMAND);
+}
+
+/**
+ * @brief Wait for the end of the running search, if any.
+ *
+ * @param engine Engine.
+ * @return The result of the last search.
+ */
+const Result* edax_search_wait(EdaxEngine *engine)
+{
+	if (engine->is_running) {
+		thread_join(engine->thread);
+		engine->is_running = false;
+	}
+
+	return &engine->result;
+}
+
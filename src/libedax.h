@@ -0,0 +1,49 @@
+/**
+ * @file libedax.h
+ *
+ * Asynchronous search interface to use Edax as a library.
+ *
+ * @date 1998 - 2026
+ * @author Richard Delorme
+ * @author Toshihiko Okuhara
+ * @version 4.5
+ */
+
+#ifndef EDAX_LIBEDAX_H
+#define EDAX_LIBEDAX_H
+
+#include "board.h"
+#include "search.h"
+
+#include <stdbool.h>
+
+/** Search limits */
+typedef struct EdaxLimits {
+	int depth;                   /**< search depth (the number of empties or more to solve) */
+	int selectivity;             /**< selectivity level (0 = 73% ... 5 = no selectivity) */
+	long long time;              /**< time per move in ms (0 = no time limit) */
+	int alpha;                   /**< lower bound of the search window */
+	int beta;                    /**< upper bound of the search window */
+} EdaxLimits;
+
+/** Engine configuration (tasks, hash table, parallel engine, speed), fixed at its creation */
+typedef SearchConfig EdaxConfig;
+
+/** Search engine (opaque) */
+typedef struct EdaxEngine EdaxEngine;
+
+/** call back function receiving the result of a search */
+typedef void (*EdaxCallback)(const Result*, void*);
+
+void edax_library_init(const char*);
+void edax_library_free(void);
+void edax_limits_init(EdaxLimits*);
+void edax_config_init(EdaxConfig*);
+EdaxEngine* edax_engine_create(const EdaxConfig*);
+void edax_engine_free(EdaxEngine*);
+bool edax_search_async(EdaxEngine*, const Board*, const EdaxLimits*, EdaxCallback, void*);
+void edax_search_cancel(EdaxEngine*);
+const Result* edax_search_wait(EdaxEngine*);
+
+#endif /* EDAX_LIBEDAX_H */
+
@@ -8,6 +8,7 @@
  * @version 4.5
  */
 
+#include "base.h"
 #include "board.h"
 #include "cassio.h"
 #include "hash.h"
@@ -53,10 +54,13 @@ void usage(void)
 		" -cassio Cassio protocol.\n"
 		" -solve <problem_file>    Automatic problem solver/checker.\n"
 		" -wtest <wthor_file>      Test edax using WThor's theoric score.\n"
+		" -q8test <obf/wtb_file>   Compare the 8-bit quantized to the 16-bit evaluation.\n"
 		" -count <level>           Count positions up to <level>.\n");
 	options_usage();
 }
 
+#ifndef EDAX_LIBRARY	// built as a library (make lib)
+
 /**
  * @brief edax main function.
  *
@@ -71,10 +75,13 @@ int main(int argc, char **argv)
 	int i, r, level = 0, size = 8;
 	char *problem_file = NULL;
 	char *wthor_file = NULL;
+	char *q8_file[64];
+	int n_q8_files = 0;
 	char *count_type = NULL;
 	int n_bench = 0;
 
-	// options.n_task default to system cpu number
+	// options.n_task default to system cpu number, counted before any thread is pinned
+	cpu_init();
 	options.n_task = get_cpu_number();
 
 	// options from edax.ini
@@ -97,6 +104,7 @@ int main(int argc, char **argv)
 		else if ((r = (options_read(arg, argv[i + 1]))) > 0) i += r - 1;
 		else if (strcmp(arg, "solve") == 0 && argv[i + 1]) problem_file = argv[++i];
 		else if (strcmp(arg, "wtest") == 0 && argv[i + 1]) wthor_file = argv[++i];
+		else if (strcmp(arg, "q8test") == 0 && argv[i + 1] && n_q8_files < 64) q8_file[n_q8_files++] = argv[++i];
 		else if (strcmp(arg, "bench") == 0 && argv[i + 1]) n_bench = atoi(argv[++i]);
 		else if (strcmp(arg, "count") == 0 && argv[i + 1]) {
 			count_type = argv[++i];
@@ -131,6 +139,20 @@ int main(int argc, char **argv)
 		if (n_bench) obf_speed(&search, n_bench);
 		search_free(&search);
 
+	} else if (n_q8_files) {
+		EvalQ8Report report;
+		char ext[8];
+		if (eval_q8_report_init(&report)) {
+			for (i = 0; i < n_q8_files; ++i) {
+				strncpy(ext, q8_file[i] + MAX(0, (int) strlen(q8_file[i]) - 4), 7); ext[7] = '\0';
+				string_to_lowercase(ext);
+				if (strcmp(ext, ".wtb") == 0) wthor_eval_q8(q8_file[i], &report);
+				else obf_eval_q8(q8_file[i], &report);
+			}
+			eval_q8_report_print(&report, stdout);
+			eval_q8_report_free(&report);
+		}
+
 	} else if (count_type){
 		Board board;
 		board_init(&board);
@@ -162,3 +184,4 @@ int main(int argc, char **argv)
 	return 0;
 }
 
+#endif /* EDAX_LIBRARY */
@@ -12,6 +12,7 @@
 #include "search.h"
 
 #include "bit.h"
+#include "nnue.h"
 #include "options.h"
 #include "stats.h"
 #include "ybwc.h"
@@ -35,7 +36,19 @@
  */
 static int accumlate_eval(int ply, Eval *eval)
 {
+	if (EVAL_NNUE)
+		return nnue_accumulate(ply, eval);
+
 	unsigned short *f = eval->feature.us;
+#if EVAL_Q8
+	if (ply >= EVAL_N_PLY)
+		ply = EVAL_N_PLY - 2 + (ply & 1);
+	ply -= 2;
+	if (ply < 0)
+		ply &= 1;
+	return eval_q8_accumulate(&(*EVAL_WEIGHT_Q8)[ply], f);
+
+#else
 	const Eval_weight *w;
 	int sum;
 
@@ -46,7 +59,36 @@ static int accumlate_eval(int ply, Eval *eval)
 		ply &= 1;
 	w = &(*EVAL_WEIGHT)[ply];
 
-#if defined(__AVX2__) && !defined(__bdver4__) && !defined(__znver1__) && !defined(__znver2__)
+  #if EVAL_AVX512
+	enum {
+		W_C9 = offsetof(Eval_weight, C9) / sizeof(short) - 1,	// -1 to load the data into hi-word
+		W_C10 = offsetof(Eval_weight, C10) / sizeof(short) - 1,
+		W_S100 = offsetof(Eval_weight, S100) / sizeof(short) - 1,
+		W_S101 = offsetof(Eval_weight, S101) / sizeof(short) - 1,
+		W_S8x4 = offsetof(Eval_weight, S8x4) / sizeof(short) - 1,
+		W_S7654 = offsetof(Eval_weight, S7654) / sizeof(short) - 1
+	};
+
+	// 16-lane gathers over the features 0-15, 16-31 & 32-45 (28 & 29 are added below)
+	__m512i FF = _mm512_add_epi32(_mm512_cvtepu16_epi32(eval->feature.v16[0]),
+		_mm512_set_epi32(W_S101, W_S101, W_S101, W_S101, W_S100, W_S100, W_S100, W_S100,
+			W_C10, W_C10, W_C10, W_C10, W_C9, W_C9, W_C9, W_C9));
+	__m512i DD = _mm512_i32gather_epi32(FF, w, 2);
+	__m512i SS = _mm512_srai_epi32(DD, 16);	// sign extend
+
+	FF = _mm512_add_epi32(_mm512_cvtepu16_epi32(eval->feature.v16[1]),
+		_mm512_set_epi32(W_S7654, W_S7654, W_S8x4, W_S8x4, W_S8x4, W_S8x4, W_S8x4, W_S8x4,
+			W_S8x4, W_S8x4, W_S8x4, W_S8x4, W_S8x4, W_S8x4, W_S8x4, W_S8x4));
+	DD = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0xcfff, FF, w, 2);
+	SS = _mm512_add_epi32(SS, _mm512_srai_epi32(DD, 16));
+
+	FF = _mm512_add_epi32(_mm512_cvtepu16_epi32(eval->feature.v16[2]), _mm512_set1_epi32(W_S7654));
+	DD = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), 0x3fff, FF, w, 2);
+	SS = _mm512_add_epi32(SS, _mm512_srai_epi32(DD, 16));
+
+	sum = _mm512_reduce_add_epi32(SS);
+
+  #elif defined(__AVX2__) && !defined(__bdver4__) && !defined(__znver1__) && !defined(__znver2__)
 	enum {
 		W_C9 = offsetof(Eval_weight, C9) / sizeof(short) - 1,	// -1 to load the data into hi-word
 		W_C10 = offsetof(Eval_weight, C10) / sizeof(short) - 1,
@@ -80,7 +122,7 @@ static int accumlate_eval(int ply, Eval *eval)
 	S = _mm_hadd_epi32(S, S);
 	sum = _mm_cvtsi128_si32(S) + _mm_extract_epi32(S, 1);
 
-#else
+  #else
 	sum = w->C9[f[ 0]] + w->C9[f[ 1]] + w->C9[f[ 2]] + w->C9[f[ 3]]
 	  + w->C10[f[ 4]] + w->C10[f[ 5]] + w->C10[f[ 6]] + w->C10[f[ 7]]
 	  + w->S100[f[ 8]] + w->S100[f[ 9]] + w->S100[f[10]] + w->S100[f[11]]
@@ -92,8 +134,9 @@ static int accumlate_eval(int ply, Eval *eval)
 	  + w->S7654[f[34]] + w->S7654[f[35]] + w->S7654[f[36]] + w->S7654[f[37]]
 	  + w->S7654[f[38]] + w->S7654[f[39]] + w->S7654[f[40]] + w->S7654[f[41]]
 	  + w->S7654[f[42]] + w->S7654[f[43]] + w->S7654[f[44]] + w->S7654[f[45]];
-#endif
+  #endif
 	return sum + w->S8x4[f[28]] + w->S8x4[f[29]] + w->S0;
+#endif
 }
 
 /**
@@ -607,7 +650,7 @@ int NWS_midgame(Search *search, const int alpha, int depth, Node *parent)
 			return NWS_shallow(search, alpha, depth, &search->hash_table);
 	} else {
 		if (depth < DEPTH_MIDGAME_TO_ENDGAME)
-			return NWS_endgame(search, alpha);
+			return NWS_endgame(search, alpha, parent);
 	}
 
 	SEARCH_STATS(++statistics.n_NWS_midgame);
@@ -378,8 +378,10 @@ void movelist_evaluate(MoveList *movelist, Search *search, const HashData *hash_
 		 9,  9,  9,  9,  9,  9,  9,  9
 	};
 	Move *move;
-	int	sort_depth, min_depth, sort_alpha, score, empties, parity_weight;
+	int	sort_depth, min_depth, sort_alpha, score, empties, parity_weight, i;
 	unsigned long long moves;
+	unsigned long long hash_code[MAX_MOVE];
+	Board next;
 	HashData dummy;
 	Eval eval0;
 	Board board0;
@@ -404,6 +406,18 @@ void movelist_evaluate(MoveList *movelist, Search *search, const HashData *hash_
 		eval0 = search->eval;
 		sort_alpha = MAX(SCORE_MIN, alpha - SORT_ALPHA_DELTA);
 
+		// prefetch the hash entries of all the moves before probing them
+		if (sort_depth >= 3) {
+			i = 0;
+			foreach_move (move, *movelist) {
+				next.opponent = board0.player ^ (move->flipped | x_to_bit(move->x));
+				next.player = board0.opponent ^ move->flipped;
+				hash_code[i] = board_get_hash_code(&next);
+				hash_prefetch(&search->hash_table, hash_code[i++]);
+			}
+		}
+
+		i = 0;
 		move = movelist->move[0].next;
 		do {
 			// move_evaluate(move, search, hash_data, sort_alpha, sort_depth);
@@ -448,7 +462,7 @@ void movelist_evaluate(MoveList *movelist, Search *search, const HashData *hash_
 					score += (SCORE_MAX - search_eval_2(search, SCORE_MIN, -sort_alpha, moves)) * (w_eval >> 1);	// 3 level score bonus
 					break;
 				default:	// 3 to 6
-					if (hash_get_from_board(&search->hash_table, &search->board, &dummy)) score += w_hash;	// bonus if the position leads to a position stored in the hash-table
+					if (hash_get(&search->hash_table, &search->board, hash_code[i], &dummy)) score += w_hash;	// bonus if the position leads to a position stored in the hash-table
 					// org_selectivity = search->selectivity;
 					// search->selectivity = NO_SELECTIVITY;	// No probcut in PVS_shallow
 					score += ((SCORE_MAX - PVS_shallow(search, SCORE_MIN, -sort_alpha, sort_depth))) * w_eval;	// > 3 level bonus
@@ -460,6 +474,7 @@ void movelist_evaluate(MoveList *movelist, Search *search, const HashData *hash_
 				search->board = board0;
 			}
 			move->score = score;
+			++i;
 		} while ((move = move->next));
 
 	} else	// sort_depth = -1
@@ -68,7 +68,7 @@ static void nboard_observer(Result *result)
 	if (log_is_open(nboard_log)) {
 		fprintf(nboard_log->f, "edax> ");
 		result_print(result, nboard_log->f);
-		putc('\n', nboard_log->f);
+		fprintf(nboard_log->f, " hashfull %d\n", result->hash_full);
 	}
 	nboard_send("nodestats %lld %.2f", result->n_nodes, result->time);
 }
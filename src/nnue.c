@@ -0,0 +1,273 @@
+/**
+ * @file nnue.c
+ *
+ * Neural network evaluation function.
+ *
+ * A small network, efficiently updatable like the pattern features:
+ * the first layer is an accumulator of 2 x 24 int16, stored in place of the
+ * pattern features (EVAL_FEATURE_V), so that it is copied, updated & restored
+ * by the search exactly as they are. Each half is seen from the perspective of
+ * a player; as for the pattern features, the first half belongs to the player
+ * to move when the number of empties is even, and a pass swaps the halves.
+ * The accumulator then goes through two clipped relu layers (int16 inputs,
+ * int8 weights) and a linear output, both selected by the game stage.
+ *
+ * Weight file (native byte order):
+ * <ul>
+ *   <li>int header[7]: EDAX, NNUE, version (1), inputs (128), half (24), l2 (16), buckets (4)</li>
+ *   <li>short w1[128][24], b1[24]: own discs then opponent's discs on a1..h8</li>
+ *   <li>for each bucket: signed char w2[16][48]; int b2[16]; signed char w3[16]; int b3</li>
+ * </ul>
+ * The output is in 1/128 discs, as the pattern evaluation.
+ *
+ * @date 2026
+ * @author Toshihiko Okuhara
+ * @version 4.5
+ */
+
+#include "nnue.h"
+
+#include "bit.h"
+#include "board.h"
+#include "const.h"
+#include "options.h"
+#include "util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/** accumulator increments of a disc of the player, the opponent, and of a flip */
+static EVAL_FEATURE_V NNUE_OWN[64], NNUE_OPP[64], NNUE_FLIP[64];
+
+/** accumulator bias */
+static EVAL_FEATURE_V NNUE_BIAS;
+
+/** output layers, by game stage */
+static struct {
+	short w2[NNUE_N_L2][NNUE_N_HIDDEN];   /**< second layer weights (int8, widened) */
+	int b2[NNUE_N_L2];                    /**< second layer bias */
+	int w3[NNUE_N_L2];                    /**< output weights (int8, widened) */
+	int b3;                               /**< output bias */
+} NNUE_OUTPUT[NNUE_N_BUCKET];
+
+/**
+ * @brief Add accumulator increments.
+ *
+ * @param a Accumulator.
+ * @param b Increments.
+ */
+static inline void nnue_add(EVAL_FEATURE_V *a, const EVAL_FEATURE_V *b)
+{
+#if defined(__AVX2__)
+	a->v16[0] = _mm256_add_epi16(a->v16[0], b->v16[0]);
+	a->v16[1] = _mm256_add_epi16(a->v16[1], b->v16[1]);
+	a->v16[2] = _mm256_add_epi16(a->v16[2], b->v16[2]);
+#elif defined(hasSSE2) || defined(__ARM_NEON)
+	int i;
+	for (i = 0; i < 6; ++i)
+  #ifdef __ARM_NEON
+		a->v8[i] = vaddq_s16(a->v8[i], b->v8[i]);
+  #else
+		a->v8[i] = _mm_add_epi16(a->v8[i], b->v8[i]);
+  #endif
+#else
+	int i;
+	for (i = 0; i < NNUE_N_HIDDEN; ++i) a->us[i] += b->us[i];
+#endif
+}
+
+/**
+ * @brief Subtract accumulator increments.
+ *
+ * @param a Accumulator.
+ * @param b Increments.
+ */
+static inline void nnue_sub(EVAL_FEATURE_V *a, const EVAL_FEATURE_V *b)
+{
+#if defined(__AVX2__)
+	a->v16[0] = _mm256_sub_epi16(a->v16[0], b->v16[0]);
+	a->v16[1] = _mm256_sub_epi16(a->v16[1], b->v16[1]);
+	a->v16[2] = _mm256_sub_epi16(a->v16[2], b->v16[2]);
+#elif defined(hasSSE2) || defined(__ARM_NEON)
+	int i;
+	for (i = 0; i < 6; ++i)
+  #ifdef __ARM_NEON
+		a->v8[i] = vsubq_s16(a->v8[i], b->v8[i]);
+  #else
+		a->v8[i] = _mm_sub_epi16(a->v8[i], b->v8[i]);
+  #endif
+#else
+	int i;
+	for (i = 0; i < NNUE_N_HIDDEN; ++i) a->us[i] -= b->us[i];
+#endif
+}
+
+/**
+ * @brief Load the network weights.
+ *
+ * @param file Weight file.
+ */
+void nnue_open(const char *file)
+{
+	int header[7];
+	short w1[NNUE_N_INPUT][NNUE_N_HALF], b1[NNUE_N_HALF];
+	signed char w2[NNUE_N_L2][NNUE_N_HIDDEN], w3[NNUE_N_L2];
+	int i, j, k, ok;
+	FILE *f;
+
+	f = fopen(file, "rb");
+	if (f == NULL) fatal_error("Cannot open %s\n", file);
+
+	ok = (fread(header, sizeof (header), 1, f) == 1);
+	if (!ok || header[0] != EDAX || header[1] != NNUE) fatal_error("%s is not an Edax network file\n", file);
+	if (header[2] != 1 || header[3] != NNUE_N_INPUT || header[4] != NNUE_N_HALF || header[5] != NNUE_N_L2 || header[6] != NNUE_N_BUCKET)
+		fatal_error("%s: unsupported network (version %d, %d x %d x %d x %d buckets)\n", file, header[2], header[3], header[4], header[5], header[6]);
+
+	ok = (fread(w1, sizeof (w1), 1, f) == 1) && (fread(b1, sizeof (b1), 1, f) == 1);
+	for (k = 0; ok && k < NNUE_N_BUCKET; ++k) {
+		ok = (fread(w2, sizeof (w2), 1, f) == 1) && (fread(NNUE_OUTPUT[k].b2, sizeof (NNUE_OUTPUT[k].b2), 1, f) == 1)
+		  && (fread(w3, sizeof (w3), 1, f) == 1) && (fread(&NNUE_OUTPUT[k].b3, sizeof (NNUE_OUTPUT[k].b3), 1, f) == 1);
+		for (j = 0; j < NNUE_N_L2; ++j) {
+			for (i = 0; i < NNUE_N_HIDDEN; ++i) NNUE_OUTPUT[k].w2[j][i] = w2[j][i];
+			NNUE_OUTPUT[k].w3[j] = w3[j];
+		}
+	}
+	fclose(f);
+	if (!ok) fatal_error("Cannot read the network weights from %s\n", file);
+
+	// a disc is own in a perspective & opponent's in the other one
+	for (i = 0; i < 64; ++i) {
+		for (j = 0; j < NNUE_N_HALF; ++j) {
+			NNUE_OWN[i].us[j] = w1[i][j];
+			NNUE_OWN[i].us[j + NNUE_N_HALF] = w1[i + 64][j];
+			NNUE_OPP[i].us[j] = w1[i + 64][j];
+			NNUE_OPP[i].us[j + NNUE_N_HALF] = w1[i][j];
+		}
+		NNUE_FLIP[i] = NNUE_OWN[i];
+		nnue_sub(&NNUE_FLIP[i], &NNUE_OPP[i]);
+	}
+	for (j = 0; j < NNUE_N_HALF; ++j)
+		NNUE_BIAS.us[j] = NNUE_BIAS.us[j + NNUE_N_HALF] = b1[j];
+
+	info("<Neural network weights loaded from %s>\n", file);
+}
+
+/**
+ * @brief Free the network (nothing is allocated).
+ */
+void nnue_close(void)
+{
+}
+
+/**
+ * @brief Set up the accumulator from a board.
+ *
+ * @param eval  Evaluation function.
+ * @param board Board to setup the accumulator from.
+ */
+void nnue_set(Eval *eval, const Board *board)
+{
+	unsigned long long own, opp;
+	int x;
+
+	if (eval->n_empties & 1) {
+		own = board->opponent; opp = board->player;
+	} else {
+		own = board->player; opp = board->opponent;
+	}
+
+	eval->feature = NNUE_BIAS;
+	foreach_bit (x, own) nnue_add(&eval->feature, &NNUE_OWN[x]);
+	foreach_bit (x, opp) nnue_add(&eval->feature, &NNUE_OPP[x]);
+}
+
+/**
+ * @brief Update the accumulator after a move.
+ *
+ * @param x        Move position.
+ * @param f        Flipped bitboard.
+ * @param eval_out Updated evaluation function.
+ * @param eval_in  Evaluation function before the move.
+ */
+void nnue_update(int x, unsigned long long f, Eval *eval_out, const Eval *eval_in)
+{
+	EVAL_FEATURE_V a = eval_in->feature;
+
+	if (eval_in->n_empties & 1) {
+		nnue_add(&a, &NNUE_OPP[x]);
+		foreach_bit (x, f) nnue_sub(&a, &NNUE_FLIP[x]);
+	} else {
+		nnue_add(&a, &NNUE_OWN[x]);
+		foreach_bit (x, f) nnue_add(&a, &NNUE_FLIP[x]);
+	}
+	eval_out->feature = a;
+}
+
+/**
+ * @brief Update/Restore the accumulator after a passing move.
+ *
+ * @param eval  Evaluation function.
+ */
+void nnue_pass(Eval *eval)
+{
+	unsigned short t;
+	int i;
+
+	for (i = 0; i < NNUE_N_HALF; ++i) {
+		t = eval->feature.us[i];
+		eval->feature.us[i] = eval->feature.us[i + NNUE_N_HALF];
+		eval->feature.us[i + NNUE_N_HALF] = t;
+	}
+}
+
+/**
+ * @brief Evaluate a position with the network.
+ *
+ * @param ply  60 - n_empties.
+ * @param eval Evaluation function.
+ * @return An evaluated score (in 1/128 discs), for the player to move.
+ */
+int nnue_accumulate(int ply, const Eval *eval)
+{
+	const int bucket = MIN(MAX(ply, 0), 59) * NNUE_N_BUCKET / 60;
+	const int first = (ply & 1) ? NNUE_N_HALF : 0;	// the perspective of the player to move comes first
+	int i, j, s, sum;
+
+	sum = NNUE_OUTPUT[bucket].b3;
+
+#if defined(hasSSE2)
+	__m128i x[6], S;
+	const __m128i zero = _mm_setzero_si128(), max = _mm_set1_epi16(127);
+
+	for (i = 0; i < 6; ++i)
+		x[i] = _mm_min_epi16(_mm_max_epi16(_mm_srai_epi16(eval->feature.v8[(i + first / 8) % 6], NNUE_SHIFT_1), zero), max);
+
+	for (j = 0; j < NNUE_N_L2; ++j) {
+		const __m128i *w = (const __m128i *) NNUE_OUTPUT[bucket].w2[j];
+		S = _mm_madd_epi16(x[0], _mm_loadu_si128(w));
+		for (i = 1; i < 6; ++i) S = _mm_add_epi32(S, _mm_madd_epi16(x[i], _mm_loadu_si128(w + i)));
+		S = _mm_add_epi32(S, _mm_shuffle_epi32(S, 0x4e));
+		S = _mm_add_epi32(S, _mm_shuffle_epi32(S, 0xb1));
+		s = (_mm_cvtsi128_si32(S) + NNUE_OUTPUT[bucket].b2[j]) >> NNUE_SHIFT_2;
+		sum += MIN(MAX(s, 0), 127) * NNUE_OUTPUT[bucket].w3[j];
+	}
+
+#else
+	short x[NNUE_N_HIDDEN];
+
+	for (i = 0; i < NNUE_N_HIDDEN; ++i) {
+		s = (short) eval->feature.us[(i + first) % NNUE_N_HIDDEN] >> NNUE_SHIFT_1;
+		x[i] = MIN(MAX(s, 0), 127);
+	}
+
+	for (j = 0; j < NNUE_N_L2; ++j) {
+		s = NNUE_OUTPUT[bucket].b2[j];
+		for (i = 0; i < NNUE_N_HIDDEN; ++i) s += x[i] * NNUE_OUTPUT[bucket].w2[j][i];
+		s >>= NNUE_SHIFT_2;
+		sum += MIN(MAX(s, 0), 127) * NNUE_OUTPUT[bucket].w3[j];
+	}
+#endif
+
+	return sum;
+}
+
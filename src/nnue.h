@@ -0,0 +1,41 @@
+/**
+ * @file nnue.h
+ *
+ * Neural network evaluation function's header.
+ *
+ * @date 2026
+ * @author Toshihiko Okuhara
+ * @version 4.5
+ */
+
+#ifndef EDAX_NNUE_H
+#define EDAX_NNUE_H
+
+#include "eval.h"
+
+/** network dimensions */
+enum {
+	NNUE_N_INPUT = 128,   /**< inputs: own & opponent discs on 64 squares */
+	NNUE_N_HALF = 24,     /**< first layer of a perspective */
+	NNUE_N_HIDDEN = 48,   /**< first layer (accumulator) of both perspectives */
+	NNUE_N_L2 = 16,       /**< second layer */
+	NNUE_N_BUCKET = 4     /**< output layers by game stage */
+};
+
+/** scaling shifts of the clipped relu layers */
+enum {
+	NNUE_SHIFT_1 = 6,
+	NNUE_SHIFT_2 = 6
+};
+
+struct Board;
+
+void nnue_open(const char*);
+void nnue_close(void);
+void nnue_set(Eval*, const struct Board*);
+void nnue_update(int, unsigned long long, Eval*, const Eval*);
+void nnue_pass(Eval*);
+int nnue_accumulate(int, const Eval*);
+
+#endif /* EDAX_NNUE_H */
+
@@ -148,15 +148,12 @@ static int obf_read(OBF *obf, FILE *f)
 }
 
 /** 
- * @brief Analyze an OBF structure.
+ * @brief Set up a search to analyze an OBF structure.
  * @param search Search.
  * @param obf OBF structure.
- * @param n position number.
  */
-static void obf_search(Search *search, OBF *obf, int n)
+static void obf_setup(Search *search, OBF *obf)
 {
-	int i, j;
-
 	search_cleanup(search);
 	search_set_board(search, &obf->board, obf->player);
 	search_set_level(search, options.level, search->eval.n_empties);
@@ -165,6 +162,49 @@ static void obf_search(Search *search, OBF *obf, int n)
 
 	if (options.play_type == EDAX_TIME_PER_MOVE) search_set_move_time(search, options.time);
 	else search_set_game_time(search, options.time);
+}
+
+/** 
+ * @brief Print the errors of a search result.
+ * @param obf OBF structure.
+ * @param result Search result.
+ */
+static void obf_print_error(OBF *obf, Result *result)
+{
+	int i, j;
+
+	for (i = 0; i < obf->n_moves; ++i) {
+		if (obf->move[i].x == result->move) break;
+	}
+	if (obf->best_score != -SCORE_INF) {
+		putchar(' ');
+		if (i < obf->n_moves) {
+			if (obf->move[i].score != obf->best_score) {
+				printf("Erroneous move: ");
+				for (j = 0; j < obf->n_moves; ++j) {
+					if (obf->move[j].score == obf->best_score) {
+						move_print(obf->move[j].x, obf->player, stdout);
+						putchar(' ');
+					}
+				}
+				printf("expected, with score %+d, error = %+d", obf->best_score, obf->best_score - obf->move[i].score);
+			}
+		} else if (obf->best_score != result->score) {
+			printf("Erroneous score: %+d expected", obf->best_score);
+		}
+	}
+	putchar('\n');
+}
+
+/** 
+ * @brief Analyze an OBF structure.
+ * @param search Search.
+ * @param obf OBF structure.
+ * @param n position number.
+ */
+static void obf_search(Search *search, OBF *obf, int n)
+{
+	obf_setup(search, obf);
 
 	if (options.verbosity >= 2) {
 		printf("\n*** problem # %d ***\n\n", n);
@@ -180,27 +220,7 @@ static void obf_search(Search *search, OBF *obf, int n)
 		if (options.verbosity == 1) { 
 			result_print(search->result, stdout);
 		}
-		for (i = 0; i < obf->n_moves; ++i) {
-			if (obf->move[i].x == search->result->move) break;
-		}
-		if (obf->best_score != -SCORE_INF) {
-			putchar(' ');
-			if (i < obf->n_moves) {
-				if (obf->move[i].score != obf->best_score) {
-					printf("Erroneous move: ");
-					for (j = 0; j < obf->n_moves; ++j) {
-						if (obf->move[j].score == obf->best_score) {
-							move_print(obf->move[j].x, obf->player, stdout);
-							putchar(' ');
-						}
-					}
-					printf("expected, with score %+d, error = %+d", obf->best_score, obf->best_score - obf->move[i].score);
-				}
-			} else if (obf->best_score != search->result->score) {
-				printf("Erroneous score: %+d expected", obf->best_score);
-			}
-		}
-		putchar('\n');
+		obf_print_error(obf, search->result);
 		if (options.verbosity >= 2) {
 			puts(search->options.separator);
 		}
@@ -208,6 +228,217 @@ static void obf_search(Search *search, OBF *obf, int n)
 	}
 }
 
+/** OBF test summary */
+typedef struct OBFSummary {
+	unsigned long long T;  /**< time */
+	unsigned long long n_nodes; /**< node count */
+	int n;                 /**< number of positions */
+	int n_bad_score;       /**< number of erroneous scores */
+	int n_bad_move;        /**< number of erroneous moves */
+	double score_error;    /**< cumulated score error */
+	double move_error;     /**< cumulated move error */
+	bool print_summary;    /**< print the errors */
+} OBFSummary;
+
+/** 
+ * @brief Check a search result against an OBF structure.
+ * @param summary Test summary.
+ * @param obf OBF structure.
+ * @param result Search result.
+ * @param w Output stream of the positions wrongly analyzed (or NULL).
+ */
+static void obf_check(OBFSummary *summary, OBF *obf, Result *result, FILE *w)
+{
+	int i;
+
+	summary->n_nodes += result->n_nodes;
+	for (i = 0; i < obf->n_moves; ++i) {
+		if (obf->move[i].x == result->move) break;
+	}
+	if (i < obf->n_moves) {
+		if (obf->move[i].score < obf->best_score) ++summary->n_bad_move;
+		if (obf->move[i].score != result->score) ++summary->n_bad_score;
+		summary->move_error += abs(obf->best_score - obf->move[i].score);
+		if (w && obf->move[i].score < obf->best_score) obf_write(obf, w);
+	} 
+	if (obf->best_score > -SCORE_INF) summary->score_error += abs(obf->best_score - result->score);
+	else summary->print_summary = true;
+}
+
+/** A batch of OBF problems, solved at once */
+typedef struct OBFBatch {
+	OBF *obf;              /**< problems */
+	Result *result;        /**< search results */
+	bool *done;            /**< solved problems */
+	int n;                 /**< number of problems */
+	int next;              /**< next problem to solve */
+	int n_checked;         /**< number of problems checked, in file order */
+	int n_free_tasks;      /**< tasks released by the solvers without problem left */
+	int n_solvers;         /**< number of running solvers */
+	OBFSummary *summary;   /**< test summary */
+	FILE *wrong;           /**< positions wrongly analyzed */
+	Lock lock;             /**< lock */
+} OBFBatch;
+
+/** A solver of an OBF batch */
+typedef struct OBFSolver {
+	OBFBatch *batch;       /**< batch of problems */
+	Search *search;        /**< search */
+	int n_tasks;           /**< number of tasks of the search */
+	Thread thread;         /**< thread */
+} OBFSolver;
+
+/** 
+ * @brief Solve the problems of a batch, until none is left.
+ *
+ * Once all the problems have been dispatched, a solver releases its tasks,
+ * which are shared by the solvers still running when they start their next
+ * problem. The results are checked and printed in the order of the file.
+ *
+ * @param v Solver cast as void.
+ * @return NULL.
+ */
+static void* obf_batch_solve(void *v)
+{
+	OBFSolver *solver = (OBFSolver*) v;
+	OBFBatch *batch = solver->batch;
+	Search *search = solver->search;
+	SpinLock spin;
+	int i, n_tasks;
+
+	for (;;) {
+		lock(batch);
+		if (batch->next == batch->n) {
+			batch->n_free_tasks += solver->n_tasks;
+			--batch->n_solvers;
+			unlock(batch);
+			break;
+		}
+		i = batch->next++;
+		n_tasks = batch->n_free_tasks / batch->n_solvers;
+		batch->n_free_tasks -= n_tasks;
+		unlock(batch);
+
+		if (n_tasks) {
+			solver->n_tasks += n_tasks;
+			search_set_task_number(search, solver->n_tasks);
+		}
+		obf_setup(search, batch->obf + i);
+		search_run(search);
+
+		lock(batch);
+		spin = batch->result[i].spin;
+		batch->result[i] = *search->result;
+		batch->result[i].spin = spin;
+		batch->done[i] = true;
+		for (; batch->n_checked < batch->n && batch->done[batch->n_checked]; ++batch->n_checked) {
+			i = batch->n_checked;
+			if (options.verbosity) {
+				printf("%3d|", i + 1);
+				result_print(batch->result + i, stdout);
+				obf_print_error(batch->obf + i, batch->result + i);
+				fflush(stdout);
+			}
+			obf_check(batch->summary, batch->obf + i, batch->result + i, batch->wrong);
+		}
+		unlock(batch);
+	}
+
+	return NULL;
+}
+
+/** 
+ * @brief Solve the problems of an OBF file, several at once.
+ *
+ * Each problem is solved by its own search, with its own hash tables, so
+ * that its result does not depend on the others (the solvers never attach to
+ * the shared hash table, except the main search). The tasks of the main
+ * search are shared out between the solvers. The time is the elapsed one,
+ * to measure the throughput.
+ *
+ * @param search Main search, used by the first solver.
+ * @param f Input OBF file.
+ * @param w Output OBF file with the position wrongly analyzed (or NULL).
+ * @param n_solvers Number of problems solved at once.
+ * @param summary Test summary.
+ */
+static void obf_batch(Search *search, FILE *f, FILE *w, int n_solvers, OBFSummary *summary)
+{
+	OBFBatch batch;
+	OBFSolver *solver;
+	SearchConfig config;
+	const int n_tasks = search_count_tasks(search);
+	const bool cpu_affinity = options.cpu_affinity;
+	int i, ok, size = 256;
+	long long t = real_clock();
+
+	batch.obf = (OBF*) malloc(size * sizeof (OBF));
+	batch.n = 0;
+	while (batch.obf && (ok = obf_read(batch.obf + batch.n, f)) != OBF_PARSE_END) {
+		if (ok == OBF_PARSE_OK) {
+			if (++batch.n == size) batch.obf = (OBF*) realloc(batch.obf, (size *= 2) * sizeof (OBF));
+		} else obf_free(batch.obf + batch.n);
+	}
+	batch.result = (Result*) malloc(MAX(batch.n, 1) * sizeof (Result));
+	batch.done = (bool*) calloc(MAX(batch.n, 1), sizeof (bool));
+	solver = (OBFSolver*) malloc(n_solvers * sizeof (OBFSolver));
+	if (batch.obf == NULL || batch.result == NULL || batch.done == NULL || solver == NULL) {
+		fatal_error("obf_test: cannot allocate a batch of %d problems\n", batch.n);
+	}
+	for (i = 0; i < batch.n; ++i) spin_init(batch.result + i);
+	batch.next = batch.n_checked = batch.n_free_tasks = 0;
+	batch.n_solvers = n_solvers = MIN(n_solvers, MAX(batch.n, 1));
+	batch.summary = summary;
+	batch.wrong = w;
+	lock_init(&batch);
+
+	// the solver threads do not run on the cpu of the main search
+	options.cpu_affinity = false;
+	thread_unset_cpu(thread_self());
+
+	// only the main search may attach to the shared hash table
+	search_config_init(&config);
+	config.hash_shared_name = NULL;
+
+	for (i = 0; i < n_solvers; ++i) {
+		solver[i].batch = &batch;
+		solver[i].n_tasks = n_tasks / n_solvers + (i < n_tasks % n_solvers);
+		if (i == 0) {
+			solver[i].search = search;
+		} else {
+			solver[i].search = (Search*) mm_malloc(sizeof (Search));
+			if (solver[i].search == NULL) fatal_error("obf_test: cannot allocate a search\n");
+			config.n_task = solver[i].n_tasks;
+			search_init_config(solver[i].search, &config);
+			solver[i].search->options.verbosity = 0;
+		}
+		search_set_task_number(solver[i].search, solver[i].n_tasks);
+	}
+	for (i = 1; i < n_solvers; ++i) thread_create(&solver[i].thread, obf_batch_solve, solver + i);
+	obf_batch_solve(solver);
+	for (i = 1; i < n_solvers; ++i) thread_join(solver[i].thread);
+
+	for (i = 1; i < n_solvers; ++i) {
+		search_free(solver[i].search);
+		mm_free(solver[i].search);
+	}
+	options.cpu_affinity = cpu_affinity;
+	if (cpu_affinity) thread_set_cpu(thread_self(), 0);
+	search_set_task_number(search, n_tasks);
+
+	summary->n = batch.n;
+	summary->T = real_clock() - t;
+
+	lock_free(&batch);
+	for (i = 0; i < batch.n; ++i) {
+		spin_free(batch.result + i);
+		obf_free(batch.obf + i);
+	}
+	free(solver);
+	free(batch.done);
+	free(batch.result);
+	free(batch.obf);
+}
 
 /** 
  * @brief Build an OBF structure.
@@ -294,16 +525,14 @@ void obf_test(Search *search, const char *obf_file, const char *wrong_file)
 {
 	FILE *f, *w = NULL;
 	OBF obf;
-	unsigned long long T = 0, n_nodes = 0;
-	int n = 0, n_bad_score = 0, n_bad_move = 0;
-	double score_error = 0.0, move_error = 0.0;
-	int i, ok;
-	bool print_summary = false;
+	OBFSummary summary = {0, 0, 0, 0, 0, 0.0, 0.0, false};
+	int ok;
+	const int n_batch = MIN(options.n_solve_batch, search_count_tasks(search));
 
 	// add observers
 //	search_cleanup(search);
 	search_set_observer(search, search_observer);
-	search->options.verbosity = (options.verbosity == 1 ? 0 : options.verbosity);
+	search->options.verbosity = (options.verbosity == 1 || n_batch > 1 ? 0 : options.verbosity);
 	options.width -= 4;
 
 	// open script file with problems
@@ -320,45 +549,38 @@ void obf_test(Search *search, const char *obf_file, const char *wrong_file)
 		}
 	}
 	
-	if (options.verbosity == 1) {
+	if (options.verbosity == 1 || (options.verbosity && n_batch > 1)) {
 		if (search->options.header) printf(" # |%s\n", search->options.header);
 		if (search->options.separator) printf("---+%s\n", search->options.separator);
 	}
 
-	while ((ok = obf_read(&obf, f)) != OBF_PARSE_END) {
-		if (ok == OBF_PARSE_OK) {
-			obf_search(search, &obf, ++n);
-		
-			T += search_time(search);
-			n_nodes += search_count_nodes(search);
-			for (i = 0; i < obf.n_moves; ++i) {
-				if (obf.move[i].x == search->result->move) break;
+	if (n_batch > 1) {
+		obf_batch(search, f, w, n_batch, &summary);
+
+	} else {
+		while ((ok = obf_read(&obf, f)) != OBF_PARSE_END) {
+			if (ok == OBF_PARSE_OK) {
+				obf_search(search, &obf, ++summary.n);
+				summary.T += search_time(search);
+				obf_check(&summary, &obf, search->result, w);
 			}
-			if (i < obf.n_moves) {
-				if (obf.move[i].score < obf.best_score) ++n_bad_move;
-				if (obf.move[i].score != search->result->score) ++n_bad_score;
-				move_error += abs(obf.best_score - obf.move[i].score);
-				if (w && obf.move[i].score < obf.best_score) obf_write(&obf, w);
-			} 
-			if (obf.best_score > -SCORE_INF) score_error += abs(obf.best_score - search->result->score);
-			else print_summary = true;
+			obf_free(&obf);			
 		}
-		obf_free(&obf);			
 	}
 
-	if (options.verbosity == 1 && search->options.separator) printf("---+%s\n", search->options.separator);
+	if ((options.verbosity == 1 || (options.verbosity && n_batch > 1)) && search->options.separator) printf("---+%s\n", search->options.separator);
 	printf("%.30s: ", obf_file);
-	if (n_nodes) printf("%llu nodes in ", n_nodes);
-	time_print(T, false, stdout);
-	if (T > 0 && n_nodes > 0) printf(" (%8.0f nodes/s).", 1000.0 * n_nodes / T);
+	if (summary.n_nodes) printf("%llu nodes in ", summary.n_nodes);
+	time_print(summary.T, false, stdout);
+	if (summary.T > 0 && summary.n_nodes > 0) printf(" (%8.0f nodes/s).", 1000.0 * summary.n_nodes / summary.T);
 	putchar('\n');
 	
-	if (print_summary) {
-		printf("%d positions; ", n);
-		printf("%d erroneous move; ", n_bad_move);
-		printf("%d erroneous score; ", n_bad_score);
-		printf("mean absolute score error = %.3f; ", score_error / n);
-		printf("mean absolute move error = %.3f\n", move_error / n);
+	if (summary.print_summary) {
+		printf("%d positions; ", summary.n);
+		printf("%d erroneous move; ", summary.n_bad_move);
+		printf("%d erroneous score; ", summary.n_bad_score);
+		printf("mean absolute score error = %.3f; ", summary.score_error / summary.n);
+		printf("mean absolute move error = %.3f\n", summary.move_error / summary.n);
 	}
 
 	options.width += 4;
@@ -523,3 +745,29 @@ void obf_speed(Search *search, const int n)
 	options.width += 4;
 	
 }
+
+/**
+ * @brief Compare the quantized to the 16-bit evaluation on the positions of an OBF file.
+ *
+ * @param obf_file OBF file.
+ * @param report Accuracy report.
+ */
+void obf_eval_q8(const char *obf_file, EvalQ8Report *report)
+{
+	FILE *f;
+	OBF obf;
+	int parse;
+
+	f = fopen(obf_file, "r");
+	if (f == NULL) {
+		warn("Cannot open file %s\n", obf_file);
+		return;
+	}
+
+	while ((parse = obf_read(&obf, f)) != OBF_PARSE_END) {
+		if (parse == OBF_PARSE_OK) eval_q8_report_add(report, &obf.board);
+		obf_free(&obf);
+	}
+
+	fclose(f);
+}
@@ -13,11 +13,13 @@
 
 
 struct Search;
+struct EvalQ8Report;
 
 void obf_test(struct Search*, const char*, const char*);
 void script_to_obf(struct Search*, const char*, const char*);
 void obf_filter(const char*, const char *);
 void obf_speed(struct Search*, const int);
+void obf_eval_q8(const char*, struct EvalQ8Report*);
 
 #endif /* EDAX_OPDTEST_H */
 
@@ -21,11 +21,18 @@
 /** global options with default value */
 Options options = {
 	22, // hash table size (2^22 * 24 * 1.125 = 113MB)
+	true, // hash huge pages
+	false, // hash numa interleave
+	false, // hash lazy clear
+	NULL, // hash shared memory name
+	HASH_POLICY_LEVEL, // hash replacement policy
 
 	{0,-2,-3}, // inc_sort_depth
 
 	1, // n_task (will be set to system available cpus at run-time)
 	false, // cpu_affinity
+	PARALLEL_YBWC, // parallel search engine
+	IDLE_SPIN, // idle spin
 
 	1, // verbosity
 	0, // noise
@@ -51,8 +58,12 @@ Options options = {
 	SCORE_MAX, // beta
 
 	false, // all_best
+	1, // solve batch
 
 	NULL, // evaluation function's weights file.
+	NULL, // cached image of the unpacked weights.
+	EVAL_TYPE_PATTERN, // evaluation function
+	NULL, // neural network weights file.
 
 	NULL, // book file
 	true,            // book usage allowed
@@ -100,8 +111,20 @@ void options_usage(void)
 		"  -noise <n>                    noise level (print search output from ply <n>).\n"
 		"  -width <n>                    line width.\n"
 		"  -h|hash-table-size <nbits>    hash table size.\n"
+		"  -hash-huge-pages <on/off>     allocate the hash table with huge pages.\n"
+		"  -hash-numa-interleave <on/off> interleave the hash table over NUMA nodes.\n"
+		"  -hash-lazy-clear <on/off>     clear the hash table by changing its date.\n"
+		"  -hash-shared <name>           share the hash table with other processes\n"
+		"                                (lockless hash entries only).\n"
+		"  -hash-policy <level/split>    hash replacement policy (lowest level entry, or\n"
+		"                                depth-preferred + always-replace entries).\n"
 		"  -n|n-tasks <n>                search in parallel using n tasks.\n"
 		"  -cpu                          search using 1 cpu/thread.\n"
+		"  -parallel <ybwc/steal/lazy>   parallel search engine (node splitting by its\n"
+		"                                owner, work stealing by idle tasks, or lazy smp).\n"
+		"  -idle-spin <n>                spin n loops before sleeping when idle (0: sleep\n"
+		"                                at once, for more tasks than cpus).\n"
+		"  -solve-batch <n>              solve n problems at once, sharing the tasks.\n"
 #ifdef __APPLE__
 		"\nCassio protocol options:\n"
 		"  -debug-cassio                 print extra-information in cassio.\n"
@@ -113,6 +136,9 @@ void options_usage(void)
 		"  -move-time <n>                search using limited time per move.\n"
 		"  -ponder <on/off>              search during opponent time.\n"
 		"  -eval-file                    read eval weight from this file.\n"
+		"  -eval-cache <file>            map the unpacked eval weights from this image file.\n"
+		"  -eval-type <pattern/nnue>     evaluate with the pattern weights or the neural network.\n"
+		"  -nnue-file <file>             read the neural network weights from this file.\n"
 		"  -book-file                    load opening book from this file.\n"
 		"  -book-usage <on/off>          play from the opening book.\n"
 		"  -book-randomness <n>          play various but worse moves from the opening book.\n"
@@ -158,7 +184,30 @@ int options_read(const char *option, const char *value)
 		else if (strcmp(option, "width") == 0) options.width = string_to_int(value, options.width);
 
 		else if (strcmp(option, "h") == 0  || strcmp(option, "hash-table-size") == 0) options.hash_table_size = string_to_int(value, options.hash_table_size);
+		else if (strcmp(option, "hash-huge-pages") == 0) parse_boolean(value, &options.hash_huge_pages);
+		else if (strcmp(option, "hash-numa-interleave") == 0) parse_boolean(value, &options.hash_numa_interleave);
+		else if (strcmp(option, "hash-lazy-clear") == 0) parse_boolean(value, &options.hash_lazy_clear);
+		else if (strcmp(option, "hash-shared") == 0) {
+#if USE_HASH_LOCKLESS
+			free(options.hash_shared_name);
+			options.hash_shared_name = string_duplicate(value);
+#else
+			warn("Option -hash-shared rejected: a shared hash table needs lockless entries (USE_HASH_LOCKLESS)\n");
+#endif
+		}
+		else if (strcmp(option, "hash-policy") == 0) {
+			if (strcmp(value, "level") == 0) options.hash_policy = HASH_POLICY_LEVEL;
+			else if (strcmp(value, "split") == 0) options.hash_policy = HASH_POLICY_SPLIT;
+			else warn("Unknown hash policy: %s\n", value);
+		}
 		else if (strcmp(option, "n") == 0 || strcmp(option, "n-tasks") == 0) options.n_task = string_to_int(value, options.n_task);
+		else if (strcmp(option, "parallel") == 0) {
+			if (strcmp(value, "ybwc") == 0) options.parallel_mode = PARALLEL_YBWC;
+			else if (strcmp(value, "steal") == 0) options.parallel_mode = PARALLEL_STEAL;
+			else if (strcmp(value, "lazy") == 0) options.parallel_mode = PARALLEL_LAZY;
+			else warn("Unknown parallel search engine: %s\n", value);
+		}
+		else if (strcmp(option, "idle-spin") == 0) options.idle_spin = string_to_int(value, options.idle_spin);
 		else if (strcmp(option, "l") == 0 || strcmp(option, "level") == 0) {
 			options.level = string_to_int(value, options.level);
 			options.play_type = EDAX_FIXED_LEVEL;
@@ -177,6 +226,7 @@ int options_read(const char *option, const char *value)
 		} else if (strcmp(option, "alpha") == 0) options.alpha = string_to_int(value, options.alpha);
 		else if (strcmp(option, "beta") == 0) options.beta = string_to_int(value, options.beta);
 		else if (strcmp(option, "all-best") == 0) parse_boolean(value, &options.all_best);
+		else if (strcmp(option, "solve-batch") == 0) options.n_solve_batch = string_to_int(value, options.n_solve_batch);
 
 		else if (strcmp(option, "o") == 0 || strcmp(option, "option-file") == 0) options_parse(value);
 		else if (strcmp(option, "speed") == 0) options.speed = string_to_real(value, options.speed);
@@ -203,6 +253,13 @@ int options_read(const char *option, const char *value)
 		else if (strcmp(option, "game-file") == 0) options.game_file = string_duplicate(value);
 
 		else if (strcmp(option, "eval-file") == 0) options.eval_file = string_duplicate(value);	// 11/13/2015
+		else if (strcmp(option, "eval-cache") == 0) options.eval_cache_file = string_duplicate(value);
+		else if (strcmp(option, "eval-type") == 0) {
+			if (strcmp(value, "pattern") == 0) options.eval_type = EVAL_TYPE_PATTERN;
+			else if (strcmp(value, "nnue") == 0) options.eval_type = EVAL_TYPE_NNUE;
+			else warn("Unknown evaluation type: %s\n", value);
+		}
+		else if (strcmp(option, "nnue-file") == 0) options.nnue_file = string_duplicate(value);
 
 		else if (strcmp(option, "book-file") == 0) options.book_file = string_duplicate(value);
 		else if (strcmp(option, "book-usage") == 0) parse_boolean(value, &options.book_allowed);
@@ -298,6 +355,8 @@ void options_bound(void)
 
 	max_threads = MIN(get_cpu_number(), MAX_THREADS);
 	BOUND(options.n_task, 1, max_threads, "n-tasks");
+	BOUND(options.n_solve_batch, 1, MAX_THREADS, "solve-batch");
+	BOUND(options.idle_spin, 0, 1000000000, "idle-spin");
 
 	BOUND(options.verbosity, 0, 4, "verbosity");
 	BOUND(options.noise, 0, 60, "noise");
@@ -330,6 +389,7 @@ void options_bound(void)
 void options_dump(FILE *f) 
 {
 	const char *(play_type[3]) = {"fixed depth", "fixed time per game", "fixed time per move"};
+	const char *(parallel_mode[3]) = {"ybwc", "steal", "lazy"};
 	const char *(boolean_string[2]) = {"false", "true"};
 	const char *(mode[4]) = {"human/edax", "edax/human", "edax/edax", "human/human"};	
 
@@ -345,8 +405,15 @@ void options_dump(FILE *f)
 
 	fprintf(f, "\tsearch options\n");
 	fprintf(f, "\tsize (in number of bits) of the hash table: %d\n", options.hash_table_size);
+	fprintf(f, "\thash table with huge pages: %s\n", boolean_string[options.hash_huge_pages]);
+	fprintf(f, "\thash table interleaved over NUMA nodes: %s\n", boolean_string[options.hash_numa_interleave]);
+	fprintf(f, "\thash table lazy clear: %s\n", boolean_string[options.hash_lazy_clear]);
+	fprintf(f, "\thash table shared memory: %s\n", options.hash_shared_name ? options.hash_shared_name : "none");
+	fprintf(f, "\thash table replacement policy: %s\n", options.hash_policy == HASH_POLICY_SPLIT ? "split" : "level");
 	fprintf(f, "\tsorting depth increment: pv = %d, all = %d, cut = %d\n",  options.inc_sort_depth[0], options.inc_sort_depth[1], options.inc_sort_depth[2]);
 	fprintf(f, "\ttask number for parallel search: %d\n", options.n_task);
+	fprintf(f, "\tparallel search engine: %s\n", parallel_mode[options.parallel_mode]);
+	fprintf(f, "\tidle spin loops before sleeping: %d\n", options.idle_spin);
 	fprintf(f, "\tsearch level: %d\n", options.level);
 	fprintf(f, "\tsearch alloted time:"); time_print(options.time, false, stdout); fprintf(f, "\n");
 	fprintf(f, "\tsearch with: %s\n", play_type[options.play_type]);
@@ -358,7 +425,11 @@ void options_dump(FILE *f)
 	fprintf(f, "\tsearch alpha: %d\n", options.alpha);
 	fprintf(f, "\tsearch beta: %d\n", options.beta);
 	fprintf(f, "\tsearch all best moves: %s\n", boolean_string[options.all_best]);
+	fprintf(f, "\tproblems solved at once: %d\n", options.n_solve_batch);
 	fprintf(f, "\teval file: %s\n", options.eval_file);
+	fprintf(f, "\teval cache: %s\n", options.eval_cache_file ? options.eval_cache_file : "none");
+	fprintf(f, "\teval type: %s\n", options.eval_type == EVAL_TYPE_NNUE ? "nnue" : "pattern");
+	fprintf(f, "\tnnue file: %s\n", options.nnue_file ? options.nnue_file : "data/nnue.dat");
 	fprintf(f, "\tbook file: %s\n", options.book_file);
 	fprintf(f, "\tbook allowed: %s\n", boolean_string[options.book_allowed]);
 	fprintf(f, "\tbook randomness: %d\n\n", options.book_randomness);
@@ -410,5 +481,8 @@ void options_free(void)
 	free(options.name);
 	free(options.book_file);
 	free(options.eval_file);
+	free(options.eval_cache_file);
+	free(options.nnue_file);
+	free(options.hash_shared_name);
 }
 
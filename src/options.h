@@ -20,14 +20,40 @@ typedef enum {
 	EDAX_TIME_PER_MOVE
 } PlayType;
 
+/** replacement policy of the hash table entries */
+typedef enum {
+	HASH_POLICY_LEVEL,  /**< replace the lowest level entry of a bucket */
+	HASH_POLICY_SPLIT   /**< keep the highest level entry in the first way, always replace the other ways */
+} HashPolicy;
+
+/** evaluation function */
+typedef enum {
+	EVAL_TYPE_PATTERN,  /**< pattern weights of the eval-file */
+	EVAL_TYPE_NNUE      /**< neural network of the nnue-file */
+} EvalType;
+
+/** parallel search engine */
+typedef enum {
+	PARALLEL_YBWC,      /**< young brothers wait concept: a node is split to idle tasks by its owner */
+	PARALLEL_STEAL,     /**< work stealing: idle tasks steal the oldest split point of another task */
+	PARALLEL_LAZY       /**< lazy smp: independent searches of the root, sharing the hash tables */
+} ParallelMode;
+
 /** options to control various heuristics */
 typedef struct {
 	int hash_table_size;                  /**< size (in number of bits) of the hash table */
+	bool hash_huge_pages;                 /**< allocate the hash table with huge pages */
+	bool hash_numa_interleave;            /**< interleave the hash table over NUMA nodes */
+	bool hash_lazy_clear;                 /**< clear the hash table by dating it instead of zeroing it */
+	char *hash_shared_name;               /**< name of the shared memory of the hash table */
+	HashPolicy hash_policy;               /**< replacement policy of the hash table */
 
 	int inc_sort_depth[3];                /**< increment sorting depth */
 
 	int n_task;                           /**< search in parallel, using n_tasks */
 	bool cpu_affinity;                    /**< set one cpu/thread to diminish context change */
+	ParallelMode parallel_mode;           /**< parallel search engine */
+	int idle_spin;                        /**< spin loops of an idle thread before it sleeps */
 
 	int verbosity;                        /**< search display */
  	int noise;                            /**< search display min depth */
@@ -53,8 +79,12 @@ typedef struct {
 	int beta;                             /**< beta bound */
 
 	bool all_best;                        /**< search for all best moves when solving problem */
+	int n_solve_batch;                    /**< number of problems solved at once */
 
 	char *eval_file;                      /**< evaluation file */
+	char *eval_cache_file;                /**< cached image of the unpacked evaluation weights */
+	EvalType eval_type;                   /**< evaluation function */
+	char *nnue_file;                      /**< neural network weight file */
 
 	char *book_file;                      /**< opening book filename */
 	bool book_allowed;                    /**< switch to use or not the opening book*/
@@ -354,10 +354,69 @@ void play_go(Play *play, const bool update)
 
 }
 
+/** HintStream: exact root scores of the current iteration of a hint search */
+typedef struct HintStream {
+	int n;                       /**< number of hinted moves */
+	int depth;                   /**< depth of the iteration */
+	int selectivity;             /**< selectivity of the iteration */
+	unsigned long long scored;   /**< moves already scored */
+	unsigned long long sent;     /**< moves already sent */
+	int score[BOARD_SIZE];       /**< scores of these moves */
+	SpinLock spin;               /**< lock */
+} HintStream;
+
+/**
+ * @brief Send a root move evaluated during a hint search to nboard.
+ *
+ * Only the moves ranking among the n best ones of the current iteration,
+ * when their exact score is known, are sent. As every move of an iteration
+ * is ranked against a subset of the final scores, the n best moves of the
+ * last iteration are always sent. A move researched with the same score
+ * (aspiration window) is not sent again.
+ *
+ * @param move_result Result of the root move.
+ * @param data Hint stream.
+ */
+static void play_hint_observer(const MoveResult *move_result, void *data)
+{
+	HintStream *stream = (HintStream*) data;
+	const int x = move_result->move;
+	unsigned long long y;
+	char s[4 * 2 + 1];
+	int i, rank;
+	bool send;
+
+	if (move_result->bound.lower != move_result->bound.upper || x < A1 || x > H8) return;
+
+	spin_lock(stream);
+		if (move_result->depth != stream->depth || move_result->selectivity != stream->selectivity) {
+			stream->depth = move_result->depth;
+			stream->selectivity = move_result->selectivity;
+			stream->scored = stream->sent = 0;
+		}
+		send = !((stream->sent & x_to_bit(x)) && stream->score[x] == move_result->score);
+		stream->scored |= x_to_bit(x);
+		stream->score[x] = move_result->score;
+		rank = 0;
+		y = stream->scored;	// tied moves are ranked by arrival order
+		foreach_bit (i, y) rank += (i != x && stream->score[i] >= move_result->score);
+		send = send && rank < stream->n;
+		if (send) stream->sent |= x_to_bit(x);
+	spin_unlock(stream);
+
+	if (send) {
+		line_to_string(&move_result->pv, 4, NULL, s);	// as line_print(pv, 10, NULL)
+		printf("search %s %d 0 %d\n", s, move_result->score, move_result->depth);	// a single call: no interleaving
+		fflush(stdout);
+	}
+}
+
 /**
  * @brief Start thinking.
  *
  * Evaluate first best moves of the position.
+ * All the moves are searched together in multi-PV mode, so that hinting
+ * several moves costs about the same time as hinting a single one.
  *
  * @param play Play.
  * @param n Number of (best) moves to evaluate.
@@ -367,9 +426,12 @@ void play_hint(Play *play, int n)
 	Line pv;
 	Move *m;
 	Search *const search = &play->search;
+	Result result;
 	MoveList book_moves;
 	GameStats stat;
 	Board b;
+	HintStream hint_stream;
+	bool stream;
 
 	if (play_is_game_over(play)) return;
 
@@ -406,20 +468,42 @@ void play_hint(Play *play, int n)
 		}
 	}
 
-	while (n--) {
+	if (n > 0) {
 		if (options.play_type == EDAX_TIME_PER_MOVE) search_set_move_time(search, options.time);
 		else search_set_game_time(search, play->time[play->player].left);
-		if (n) search->options.multipv_depth = 60;
+		stream = (n > 1 && play->type == UI_NBOARD);
+		if (n > 1) search->options.multipv_depth = 60; // search all the moves together with an exact score
+		if (stream) { // stream the n best moves of each iteration
+			spin_init(&hint_stream);
+			hint_stream.n = n;
+			hint_stream.depth = -1;
+			search_set_move_observer(search, play_hint_observer, &hint_stream);
+		}
 		search_run(search);
+		if (stream) {
+			search_set_move_observer(search, NULL, NULL);
+			spin_free(&hint_stream);
+		}
 		search->options.multipv_depth = MULTIPV_DEPTH;
-		if (play->type == UI_NBOARD) {
-			printf("search "); line_print(&search->result->pv, 10, NULL, stdout);
-			printf(" %d 0 %d\n", search->result->score, search->result->depth);
-		} else {
-			if (options.verbosity == 0) search->observer(search->result);
+
+		if (search->stop != STOP_END) n = 1;
+		else if (stream) n = 0;	// already sent
+		foreach_move (m, search->movelist) if (n) {
+			--n;
+			result = *search->result;
+			if (m->x != result.move) {
+				result.move = m->x;
+				result.score = m->score;
+				result.bound[m->x].lower = result.bound[m->x].upper = m->score;
+				search_get_move_pv(search, m, &result.pv);
+			}
+			if (play->type == UI_NBOARD) {
+				printf("search "); line_print(&result.pv, 10, NULL, stdout);
+				printf(" %d 0 %d\n", result.score, result.depth);
+			} else {
+				if (options.verbosity == 0 || m != movelist_first(&search->movelist)) search->observer(&result);
+			}
 		}
-		if (search->stop != STOP_END) break;
-		movelist_exclude(&search->movelist, search->result->move);
 	}
 	if (options.verbosity) {
 		info("\n[stop thinking]\n");
@@ -135,6 +135,50 @@ static int guess_move(Search *search, Board *board)
 	return hash_data.move[0];
 }
 
+/**
+ * @brief Retrieve the principal variation of a root move.
+ *
+ * The variation is followed into the hash tables as long as the stored
+ * positions match the expected depth, selectivity and score bounds.
+ *
+ * @param search Search.
+ * @param x Root move.
+ * @param depth Depth.
+ * @param bound Score bounds of the root move.
+ * @param fail_low Fail-low flag of the root move.
+ * @param guess_pv Guess the missing moves of fail-low positions.
+ * @param pv Principal variation.
+ */
+static void get_pv(Search *search, int x, int depth, Bound bound, bool fail_low, const bool guess_pv, Line *pv)
+{
+	Board board = search->board;
+	Move move;
+	unsigned long long hash_code;
+	HashData hash_data;
+	int tmp;
+
+	line_init(pv, search->player);
+
+	while (x != NOMOVE) {
+		board_get_move_flip(&board, x, &move);
+		if (board_check_move(&board, &move)) {
+			board_update(&board, &move);
+			--depth; 
+			tmp = bound.upper; bound.upper = -bound.lower; bound.lower = -tmp;
+			fail_low = !fail_low;
+			line_push(pv, move.x);
+
+			hash_code = board_get_hash_code(&board);
+			if ((hash_get(&search->pv_table, &board, hash_code, &hash_data) || hash_get(&search->hash_table, &board, hash_code, &hash_data)) 
+			 && (hash_data.wl.c.depth >= depth && hash_data.wl.c.selectivity >= search->selectivity)
+			 && (hash_data.upper <= bound.upper && hash_data.lower >= bound.lower)) {
+				x = hash_data.move[0];
+			} else x = NOMOVE;
+			if (guess_pv && x == NOMOVE && fail_low) x = guess_move(search, &board);
+		} else x = NOMOVE;
+	}
+}
+
 /**
  * @brief Record best move.
  *
@@ -146,20 +190,11 @@ static int guess_move(Search *search, Board *board)
  */
 void record_best_move(Search *search, const Move *bestmove, const int alpha, const int beta, const int depth)
 {
-	Board board;
-	Move move;
 	Result *result = search->result;
-	int x;
-	unsigned long long hash_code;
-	HashData hash_data;
 	bool has_changed;
 	Bound *bound = result->bound + bestmove->x;
-	bool fail_low;
 	bool guess_pv;
-	int expected_depth, expected_selectivity, tmp;
-	Bound expected_bound;
-
-	board = search->board;
+	const int full = hash_full(&search->hash_table);	// sampled out of the lock
 
 	spin_lock(result);
 
@@ -177,37 +212,15 @@ void record_best_move(Search *search, const Move *bestmove, const int alpha, con
 		if (result->score > alpha) bound->lower = result->score; else bound->lower = search->stability_bound.lower;
 	}
 
-	expected_depth = result->depth = depth;
-	expected_selectivity = result->selectivity = search->selectivity;
-	expected_bound = *bound;
-
-	line_init(&result->pv, search->player);
-	x = bestmove->x;
+	result->depth = depth;
+	result->selectivity = search->selectivity;
 
 	guess_pv = (search->options.guess_pv && depth == search->eval.n_empties && (bestmove->score <= alpha || bestmove->score >= beta));
-	fail_low = (bestmove->score <= alpha);
-
-	while (x != NOMOVE) {
-		board_get_move_flip(&board, x, &move);
-		if (board_check_move(&board, &move)) {
-			board_update(&board, &move);
-			--expected_depth; 
-			tmp = expected_bound.upper; expected_bound.upper = -expected_bound.lower; expected_bound.lower = -tmp;
-			fail_low = !fail_low;
-			line_push(&result->pv, move.x);
-
-			hash_code = board_get_hash_code(&board);
-			if ((hash_get(&search->pv_table, &board, hash_code, &hash_data) || hash_get(&search->hash_table, &board, hash_code, &hash_data)) 
-			 && (hash_data.wl.c.depth >= expected_depth && hash_data.wl.c.selectivity >= expected_selectivity)
-			 && (hash_data.upper <= expected_bound.upper && hash_data.lower >= expected_bound.lower)) {
-				x = hash_data.move[0];
-			} else x = NOMOVE;
-			if (guess_pv && x == NOMOVE && fail_low) x = guess_move(search, &board);
-		} else x = NOMOVE;
-	}
+	get_pv(search, bestmove->x, depth, *bound, bestmove->score <= alpha, guess_pv, &result->pv);
 
 	result->time = search_time(search);
 	result->n_nodes = search_count_nodes(search);
+	result->hash_full = full;
 
 	spin_unlock(result);
 
@@ -220,7 +233,8 @@ void record_best_move(Search *search, const Move *bestmove, const int alpha, con
 			log_print(search_log, "%+03d < score = %+03d < %+03d; time = ", result->bound[result->move].lower, result->score, result->bound[result->move].upper);
 			time_print(result->time, false, search_log->f);
 			log_print(search_log, "; nodes = %lld N; ", result->n_nodes);
-			if (result->time > 0) {log_print(search_log, "speed = %9.0f Nps", 1000.0 * result->n_nodes / result->time);}
+			if (result->time > 0) {log_print(search_log, "speed = %9.0f Nps; ", 1000.0 * result->n_nodes / result->time);}
+			log_print(search_log, "hashfull = %d", result->hash_full);
 			log_print(search_log, "\npv = ");
 			line_print(&result->pv, 200, " ", search_log->f);
 			log_print(search_log, "\npv-debug = ");
@@ -233,6 +247,54 @@ void record_best_move(Search *search, const Move *bestmove, const int alpha, con
 	if (has_changed && options.noise <= depth && search->options.verbosity == 3) search->observer(search->result);
 }
 
+/**
+ * @brief Record the result of a root move.
+ *
+ * The result is sent to the move observer, if any, as soon as the move has
+ * been searched, so that a client sees every root move without waiting for
+ * the whole iteration to complete. In multi-PV mode the scores are exact,
+ * otherwise the moves refuted by the best one only get an upper bound.
+ * The observer is called from the searching thread, master or slave, without
+ * any lock held: it has to be thread-safe.
+ *
+ * @param search Search.
+ * @param move Searched root move.
+ * @param alpha Alpha Bound.
+ * @param beta Beta Bound.
+ * @param depth Depth.
+ */
+void record_root_move(Search *search, const Move *move, const int alpha, const int beta, const int depth)
+{
+	MoveResult move_result;
+
+	if (search->move_observer == NULL || search->helper || search->stop) return;
+
+	move_result.move = move->x;
+	move_result.score = move->score;
+	move_result.depth = depth;
+	move_result.selectivity = search->selectivity;
+	move_result.bound.lower = (move->score > alpha ? move->score : search->stability_bound.lower);
+	move_result.bound.upper = (move->score < beta ? move->score : search->stability_bound.upper);
+	get_pv(search, move->x, depth, move_result.bound, move->score <= alpha, false, &move_result.pv);
+
+	search->move_observer(&move_result, search->move_observer_data);
+}
+
+/**
+ * @brief Get the principal variation of a root move searched in multi-PV mode.
+ *
+ * @param search Search.
+ * @param move Root move with an exact score.
+ * @param pv Principal variation.
+ */
+void search_get_move_pv(Search *search, const Move *move, Line *pv)
+{
+	Bound bound;
+
+	bound.lower = bound.upper = move->score;
+	get_pv(search, move->x, search->result->depth, bound, false, false, pv);
+}
+
 void show_current_move(FILE *f, Search *search, const Move *move, const int alpha, const int beta, const bool parallel) {
 	char s[4];
 
@@ -349,6 +411,7 @@ int PVS_root(Search *search, const int alpha, const int beta, const int depth)
 
 	node_init(&node, search, alpha, beta, depth, movelist->n_moves, NULL);
 	node.pv_node = true;
+	node.multipv = (depth <= search->options.multipv_depth);
 	search->node_type[0] = PV_NODE;
 	search->time.can_update = false;
 
@@ -381,6 +444,7 @@ int PVS_root(Search *search, const int alpha, const int beta, const int depth)
 			search->board = board0;
 			if (log_is_open(search_log)) show_current_move(search_log->f, search, move, alpha, beta, false);
 			node_update(&node, move);
+			record_root_move(search, move, alpha, beta, depth);
 			if (search->options.verbosity == 4) pv_debug(search, move, stdout);
 
 			search->time.can_update = true;
@@ -390,7 +454,7 @@ int PVS_root(Search *search, const int alpha, const int beta, const int depth)
 				const int alpha = depth > search->options.multipv_depth ? node.alpha : SCORE_MIN;
 
 				assert(board_check_move(&search->board, move));
-				if (depth > search->options.multipv_depth && node_split(&node, move)) {
+				if (node_split(&node, move)) {
 				} else {
 					search_update_midgame(search, move);
 						move->score = -search_route_PVS(search, -alpha - 1, -alpha, depth - 1, &node);
@@ -404,6 +468,7 @@ int PVS_root(Search *search, const int alpha, const int beta, const int depth)
 					search->board = board0;
 					if (log_is_open(search_log)) show_current_move(search_log->f, search, move, alpha, beta, false);
 					node_update(&node, move);
+					record_root_move(search, move, alpha, beta, depth);
 					assert(SCORE_MIN <= node.bestscore && node.bestscore <= SCORE_MAX);
 				}
 				if (search->options.verbosity == 4) pv_debug(search, move, stdout);
@@ -419,6 +484,11 @@ int PVS_root(Search *search, const int alpha, const int beta, const int depth)
 		if (movelist->n_moves) {	// 4.5.1
 			if (depth < search->options.multipv_depth) movelist_sort(movelist);
 			else movelist_sort_cost(movelist, &hash_data.data);
+			if (search->helper && movelist->n_moves > 2) { // lazy smp: each helper tries another second move
+				int k = 1 + search->helper % (movelist->n_moves - 1);
+				for (move = movelist_first(movelist); k > 0; --k) move = move_next(move);
+				movelist_sort_bestmove(movelist, move->x);
+			}
 			movelist_sort_bestmove(movelist, node.bestmove);
 		}
 		record_best_move(search, movelist_first(movelist), alpha, beta, depth);
@@ -535,7 +605,7 @@ int aspiration_search(Search *search, int alpha, int beta, const int depth, int
 
 		// check PV if alpha < score < beta
 		if (is_depth_solving(depth, search->eval.n_empties)
-		&& ((alpha < score && score < beta) || (score == alpha && score == options.alpha) || (score == beta && score == options.beta))
+		&& ((alpha < score && score < beta) || (score == alpha && score == search->options.alpha) || (score == beta && score == search->options.beta))
 		&& !is_pv_ok(search, search->result->move, depth)) {
 			log_print(search_log, "*** WRONG PV => re-research id %d ***\n", search->id);
 			if (log_is_open(search_log)) {
@@ -562,6 +632,7 @@ int aspiration_search(Search *search, int alpha, int beta, const int depth, int
 	if (!search->stop) record_best_move(search, movelist_first(&search->movelist), alpha, beta, depth);
 	search->result->time = search_time(search);
 	search->result->n_nodes = search_count_nodes(search);
+	search->result->hash_full = hash_full(&search->hash_table);
 	if (options.noise <= depth && search->options.verbosity >= 2) {
 		search->observer(search->result);
 	}
@@ -645,6 +716,7 @@ void iterative_deepening(Search *search, int alpha, int beta)
 	result->selectivity = 0;
 	result->time = 0;
 	result->n_nodes = 0;
+	result->hash_full = 0;
 	line_init(&result->pv, search->player);
 
 	// special case: game over...
@@ -725,6 +797,7 @@ void iterative_deepening(Search *search, int alpha, int beta)
 		if (start <= 0) start = 2 - (end & 1);
 		if (start > end) start = end;
 	}
+	if ((search->helper & 1) && start + 2 <= end) start += 2; // lazy smp: odd helpers start one iteration deeper
 
 	if (log_is_open(search_log)) {
 		log_print(search_log,"date: pv = %d, main = %d %s\n", search->pv_table.date, search->hash_table.date, search->options.keep_date ? "(keep)":"");
@@ -758,6 +831,7 @@ void iterative_deepening(Search *search, int alpha, int beta)
 	if (options.noise <= start && search->options.verbosity >= 2) {
 		search->result->time = search_time(search);
 		search->result->n_nodes = search_count_nodes(search);
+		search->result->hash_full = hash_full(&search->hash_table);
 		search->observer(search->result);
 	}
 
@@ -798,35 +872,14 @@ void iterative_deepening(Search *search, int alpha, int beta)
 }
 
 /**
- * @brief Search the bestmove of a given board.
- *
- * this is a function runable within its own thread.
- * The board is supposed to have been set (by search_set_board()), and all
- * search options (level, time, etc.) too. this function proceeds to some
- * internal initialisations and then call the iterative deepening function, from
- * where the search is actually done. After the search ends, some finalizations
- * are done before the function returns.
+ * @brief Initialize the root of a search.
  *
- * @param v Search cast as void.
- * @return The search result.
+ * @param search Search.
  */
-void* search_run(void *v)
+static void search_run_init(Search *search)
 {
-	Search *search = (Search*) v;
 	Move *move;
 
-	search->stop = RUNNING;
-
-	//initialisations
-	search->n_nodes = 0;
-	search->child_nodes = 0;
-	search->time.spent = -search_clock(search);
-	search_time_init(search);
-	if (!search->options.keep_date) {
-		hash_clear(&search->hash_table);
-		hash_clear(&search->pv_table);
-		hash_clear(&search->shallow_table);
-	}
 	search->height = 0;
 	search->node_type[search->height] = PV_NODE;
 	search->depth_pv_extension = get_pv_extension(0, search->eval.n_empties);
@@ -845,12 +898,48 @@ void* search_run(void *v)
 		search->result->bound[PASS].lower = SCORE_MIN;
 		search->result->bound[PASS].upper = SCORE_MAX;
 	}
-	
+}
+
+/**
+ * @brief Search the bestmove of a given board within an alphabeta window.
+ *
+ * The board is supposed to have been set (by search_set_board()), and all
+ * search options (level, time, etc.) too. this function proceeds to some
+ * internal initialisations and then call the iterative deepening function, from
+ * where the search is actually done. After the search ends, some finalizations
+ * are done before the function returns.
+ * The search must already be set RUNNING by the caller, so that a stop request
+ * sent before the search actually starts is not lost.
+ *
+ * @param search Search.
+ * @param alpha Alpha bound.
+ * @param beta Beta bound.
+ * @return The search result.
+ */
+Result* search_run_window(Search *search, const int alpha, const int beta)
+{
+	//initialisations
+	search->n_nodes = 0;
+	search->child_nodes = 0;
+	search->time.spent = -search_clock(search);
+	search_time_init(search);
+	if (!search->options.keep_date) {
+		hash_clear(&search->hash_table);
+		hash_clear(&search->pv_table);
+		hash_clear(&search->shallow_table);
+	}
+	search->options.alpha = alpha;
+	search->options.beta = beta;
+	search_run_init(search);
+	if (search->options.parallel_mode == PARALLEL_LAZY) lazy_smp_start(search);
+
 	// search using iterative deepening (& widening).
-	iterative_deepening(search, options.alpha, options.beta);
+	iterative_deepening(search, alpha, beta);
 
 	// finalizations
+	if (search->options.parallel_mode == PARALLEL_LAZY) lazy_smp_stop(search);
 	search->result->n_nodes = search_count_nodes(search);
+	search->result->hash_full = hash_full(&search->hash_table);
 	if (search->options.verbosity) {
 		if (search->options.verbosity == 1 || options.noise > search->result->depth) search->observer(search->result);
 		if (search->stop == STOP_TIMEOUT) {info("[Search out of time]\n");}
@@ -865,7 +954,7 @@ void* search_run(void *v)
 		if (search->stop == STOP_TIMEOUT) log_print(search_log, "out of time");
 		else if (search->stop == STOP_ON_DEMAND) log_print(search_log, "stopped on user demand");
 		else if (search->stop == STOP_PONDERING) log_print(search_log, "stop pondering");
-		else if (search->stop == STOP_PARALLEL_SEARCH) log_print(search_log, "### BUG: stop parallel search reached root! ###");
+		else if (search->stop == STOP_PARALLEL_SEARCH || search->stop == STOP_PARALLEL_CUTOFF) log_print(search_log, "### BUG: stop parallel search reached root! ###");
 		else if (search->stop == RUNNING) log_print(search_log, "completed");
 		else log_print(search_log, "### BUG: unkwown stop condition %d ###", search->stop);
 		log_print(search_log, " ***\n\n");
@@ -884,3 +973,39 @@ void* search_run(void *v)
 	return search->result;
 }
 
+/**
+ * @brief Search the bestmove of a given board.
+ *
+ * this is a function runable within its own thread.
+ * The search window is the one set by the alpha & beta options, and the
+ * parallel search engine & the simulated speed are those of the parallel & nps
+ * options.
+ *
+ * @param v Search cast as void.
+ * @return The search result.
+ */
+void* search_run(void *v)
+{
+	Search *search = (Search*) v;
+
+	search->stop = RUNNING;
+	search->options.parallel_mode = options.parallel_mode;
+	search->options.nps = options.nps;
+
+	return search_run_window(search, options.alpha, options.beta);
+}
+
+/**
+ * @brief Search the root as a lazy smp helper.
+ *
+ * The helper runs its own iterative deepening on the position of the main
+ * search, into a private result. It only communicates with the main search
+ * through the shared hash tables, and stops with it.
+ *
+ * @param search Helper search, cloned from the main search and set running.
+ */
+void search_run_helper(Search *search)
+{
+	search_run_init(search);
+	iterative_deepening(search, search->options.alpha, search->options.beta);
+}
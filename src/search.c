@@ -69,6 +69,7 @@
 #include <assert.h>
 #include <limits.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 Log search_log[1];
@@ -345,28 +346,112 @@ void search_global_init(void)
 	search_log->f = NULL;
 }
 
-void search_resize_hashtable(Search *search) {
-	if (search->options.hash_size != options.hash_table_size) {
-		const int hash_size = 1u << options.hash_table_size;
+/**
+ * @brief Reset the hash table replacement counters of a search.
+ *
+ * Each search counts its replacements in its own copy of the hash tables.
+ *
+ * @param search Search.
+ */
+static void search_reset_hash_count(Search *search)
+{
+	memset(search->hash_count, 0, sizeof (search->hash_count));
+	memset(search->child_hash_count, 0, sizeof (search->child_hash_count));
+	search->hash_table.count = search->hash_count;
+	search->pv_table.count = search->hash_count + 1;
+	search->shallow_table.count = search->hash_count + 2;
+}
+
+/**
+ * @brief Resize the hash tables of a search.
+ *
+ * @param search Search.
+ * @param size Hash table size (2^size entries).
+ * @param shared_name Shared memory name of the hash table (or NULL).
+ */
+static void search_set_hashtable(Search *search, const int size, const char *shared_name)
+{
+	if (search->options.hash_size != size) {
+		const int hash_size = 1u << size;
 		const int pv_shallow_size = hash_size > 16 ? hash_size >> 4 : 1;
 
-		hash_init(&search->hash_table, hash_size);
+		if (shared_name) hash_init_shared(&search->hash_table, hash_size, shared_name);
+		else hash_init(&search->hash_table, hash_size);
 		hash_init(&search->pv_table, pv_shallow_size);
 		hash_init(&search->shallow_table, pv_shallow_size);
-		search->options.hash_size = options.hash_table_size;
+		search_reset_hash_count(search);
+		search->options.hash_size = size;
 	}
 }
 
 /**
- * @brief Init the *main* search.
+ * @brief Resize the hash tables of a search to the hash-table-size option.
+ *
+ * @param search Search.
+ */
+void search_resize_hashtable(Search *search) {
+	search_set_hashtable(search, options.hash_table_size, options.hash_shared_name);
+}
+
+/**
+ * @brief Associate the main search with the first task of its task stack.
+ *
+ * @param search Search.
+ */
+static void search_set_task(Search *search)
+{
+	search_resize_child(search, search->tasks->n);
+	search->task = search->tasks->task;
+	if (search->task) {
+		search->task->loop = false;
+		search->task->run = true;
+		search->task->node = NULL;
+		search->task->move = NULL;
+		search->task->n_calls = 0;
+		search->task->n_nodes = 0;
+		search->task->search = search;
+	}
+}
+
+/**
+ * @brief Set a search configuration from the global options.
+ *
+ * @param config Search configuration.
+ */
+void search_config_init(SearchConfig *config)
+{
+	config->n_task = options.n_task;
+	config->hash_table_size = options.hash_table_size;
+	config->hash_shared_name = options.hash_shared_name;
+	config->parallel_mode = options.parallel_mode;
+	config->nps = options.nps;
+}
+
+/**
+ * @brief Init the *main* search, configured by the global options.
  *
- * Initialize a new search structure.
  * @param search  search.
  */
 void search_init(Search *search)
+{
+	SearchConfig config;
+
+	search_config_init(&config);
+	search_init_config(search, &config);
+}
+
+/**
+ * @brief Init the *main* search.
+ *
+ * Initialize a new search structure, with its own tasks & hash tables.
+ * @param search  search.
+ * @param config  search configuration.
+ */
+void search_init_config(Search *search, const SearchConfig *config)
 {
 	/* id */
 	search->id = 0;
+	search->helper = 0;
 
 	/* running state */
 	search->stop = STOP_END;
@@ -379,7 +464,11 @@ void search_init(Search *search)
 	search->pv_table.hash_mask = 0;
 	search->shallow_table.hash = NULL;
 	search->shallow_table.hash_mask = 0;
-	search_resize_hashtable(search);
+	search_reset_hash_count(search);
+	search_set_hashtable(search, config->hash_table_size, config->hash_shared_name);
+
+	/* endgame cache */
+	endcache_init(search);
 
 	/* board */
 	search->board.player = search->board.opponent = 0;
@@ -397,25 +486,21 @@ void search_init(Search *search)
 		fatal_error("Cannot allocate a task stack\n");
 	}
 	if (options.cpu_affinity) thread_set_cpu(thread_self(), 0);
-	task_stack_init(search->tasks, options.n_task);
+	task_stack_init(search->tasks, config->n_task);
 	search->allow_node_splitting = (search->tasks->n > 1);
 
 	/* task associated with the current search */
-	search->task = search->tasks->task;
-	search->task->loop = false;
-	search->task->run = true;
-	search->task->node = NULL;
-	search->task->move = NULL;
-	search->task->n_calls = 0;
-	search->task->n_nodes = 0;
-	search->task->search = search;
+	search->child = NULL;
+	search->n_child = search->n_child_max = 0;
+	search->help_search = NULL;
+	search_set_task(search);
 
 	search->parent = NULL;
-	search->n_child = 0;
 	search->master = search; /* main search */
 
 	/* lock */
 	spin_init(search);
+	eventcount_init(&search->helper_event);
 
 	/* result */
 	search->result = (Result*) malloc(sizeof (Result));
@@ -424,6 +509,7 @@ void search_init(Search *search)
 	}
 	spin_init(search->result);
 	search->result->move = NOMOVE;
+	search->result->hash_full = 0;
 
 	search->n_nodes = 0;
 	search->child_nodes = 0;
@@ -431,6 +517,8 @@ void search_init(Search *search)
 
 	/* observers */
 	search->observer = search_observer;
+	search->move_observer = NULL;
+	search->move_observer_data = NULL;
 
 	/* options */
 	search->options.depth = 60;
@@ -443,6 +531,10 @@ void search_init(Search *search)
 	search->options.separator = NULL;
 	search->options.guess_pv = options.pv_guess;
 	search->options.multipv_depth = MULTIPV_DEPTH;
+	search->options.parallel_mode = config->parallel_mode;
+	search->options.nps = config->nps;
+	search->options.alpha = SCORE_MIN;
+	search->options.beta = SCORE_MAX;
 
 	log_open(search_log, options.search_log_file);
 }
@@ -459,11 +551,15 @@ void search_free(Search *search)
 	hash_free(&search->hash_table);
 	hash_free(&search->pv_table);
 	hash_free(&search->shallow_table);
+	endcache_free(search);
 	// eval_free(search->eval);
 	
 	task_stack_free(search->tasks);
 	free(search->tasks);
+	if (search->help_search) task_search_destroy(search->help_search);
+	free(search->child);
 	spin_free(search);
+	eventcount_free(&search->helper_event);
 
 	spin_free(search->result);
 	free(search->result);
@@ -524,54 +620,185 @@ void search_setup(Search *search)
 }
 
 /**
- * @brief Clone a search for parallel search.
+ * @brief Attach a child search to a master search, for parallel search.
+ *
+ * The child shares the hash tables, the tasks, the options and the result of
+ * the master, and searches the same iteration, but its position is not set:
+ * only what the master does not change while searching is read, so that a
+ * search can be attached to a master running in another thread.
  *
  * @param search search.
- * @param master search to be cloned.
+ * @param master master search.
  */
-void search_clone(Search *search, Search *master)
+void search_attach(Search *search, Search *master)
 {
 	search->stop = STOP_END;
 	search->player = master->player;
-	search->board = master->board;
-	search_setup(search);
 	search->hash_table = master->hash_table; // share the hashtable
 	search->pv_table = master->pv_table; // share the pvtable
 	search->shallow_table = master->shallow_table; // share the shallowtable
+	search_reset_hash_count(search);
 	search->tasks = master->tasks;
 	search->observer = master->observer;
+	search->move_observer = master->move_observer;
+	search->move_observer_data = master->move_observer_data;
 
 	search->depth = master->depth;
-	search->selectivity = master->selectivity;
-	search->probcut_level = master->probcut_level;
 	search->depth_pv_extension = master->depth_pv_extension;
 	search->time = master->time;
-	search->height = master->height;
 	search->allow_node_splitting = master->allow_node_splitting;
-	search->node_type[search->height] = master->node_type[search->height];
 	search->options = master->options;
 	search->result = master->result;
 	search->n_nodes = 0;
 	search->child_nodes = 0;
 	search->stability_bound = master->stability_bound;
+	if (search->n_child_max < master->n_child_max) search_resize_child(search, master->n_child_max);
 	spin_lock(master);
-	assert(master->n_child < MAX_THREADS);
+	assert(master->n_child < master->n_child_max);
 	master->child[master->n_child++] = search;
 	spin_unlock(master);
+	search->helper = 0;
 	search->parent = master;
 	search->master = master->master;
 }
 
+/**
+ * @brief Clone a search for parallel search.
+ *
+ * The child search is attached to the master, and gets its current position.
+ * The incremental state of the master (board, evaluation features, list of
+ * empty squares and parity) is copied, rather than rebuilt from the board, as
+ * it is up to date at a split node. The master must not be searching while it
+ * is cloned: this is done from its own thread.
+ *
+ * @param search search.
+ * @param master search to be cloned.
+ */
+void search_clone(Search *search, Search *master)
+{
+	search_attach(search, master);
+	search->board = master->board;
+	search->eval = master->eval;	// cheaper than search_setup()
+	memcpy(search->empties, master->empties, sizeof (search->empties));
+	search->selectivity = master->selectivity;
+	search->probcut_level = master->probcut_level;
+	search->height = master->height;
+	search->node_type[search->height] = master->node_type[search->height];
+}
+
+/**
+ * @brief Resize the array of the child searches.
+ *
+ * As every child search runs within its own task, a search cannot have more
+ * children than the size of its task stack.
+ *
+ * @param search search.
+ * @param n Size of the task stack.
+ */
+void search_resize_child(Search *search, const int n)
+{
+	assert(search->n_child == 0);
+	search->n_child_max = MAX(n, 1);
+	search->child = (Search**) realloc(search->child, search->n_child_max * sizeof (Search*));
+	if (search->child == NULL) {
+		fatal_error("Cannot allocate an array of %d child searches\n", search->n_child_max);
+	}
+}
+
 /**
  * @brief Clean-up some search data.
  *
+ * With the lazy clear option, the hash tables are not zeroed, but only dated
+ * as older, so that their entries are replaced first. Their content stays
+ * readable, as it is still valid for the positions it records. A hash table
+ * shared with other processes, or warmed by a loaded image or by the opening
+ * book, is always dated.
+ *
  * @param search search.
  */
 void search_cleanup(Search *search)
 {
-	hash_cleanup(&search->hash_table);
-	hash_cleanup(&search->pv_table);
-	hash_cleanup(&search->shallow_table);
+	if (options.hash_lazy_clear) {
+		hash_clear(&search->hash_table);
+		hash_clear(&search->pv_table);
+		hash_clear(&search->shallow_table);
+	} else {
+		// keep the entries used by other processes, loaded from an image or fed from the book
+		if (search->hash_table.shared || search->hash_table.warm) hash_clear(&search->hash_table);
+		else hash_cleanup(&search->hash_table);
+		if (search->pv_table.warm) hash_clear(&search->pv_table);
+		else hash_cleanup(&search->pv_table);
+		hash_cleanup(&search->shallow_table);
+	}
+}
+
+/**
+ * @brief Save the hash tables into a file.
+ *
+ * The main and pv hash tables are saved, so that a later session can resume
+ * the analysis where this one stopped.
+ *
+ * @param search search.
+ * @param file File name.
+ */
+void search_save_hashtable(Search *search, const char *file)
+{
+	FILE *f = fopen(file, "wb");
+
+	if (f == NULL) {
+		warn("Cannot open hash file %s\n", file);
+		return;
+	}
+	if (!hash_save(&search->hash_table, f) || !hash_save(&search->pv_table, f)) {
+		warn("Cannot save hash file %s\n", file);
+	}
+	fclose(f);
+}
+
+/**
+ * @brief Print a report of the hash tables.
+ *
+ * @param search search.
+ * @param f Output stream.
+ */
+void search_report_hashtable(Search *search, FILE *f)
+{
+	HashReport report;
+	HashCount count[3] = {{0, 0}, {0, 0}, {0, 0}};
+
+	search_count_hash(search, count);
+	hash_report(&search->hash_table, &report, 65536);
+	report.n_overwrite = count[0].n_overwrite; report.n_collision = count[0].n_collision;
+	hash_report_print(&report, "hash table", f);
+	hash_report(&search->pv_table, &report, 65536);
+	report.n_overwrite = count[1].n_overwrite; report.n_collision = count[1].n_collision;
+	hash_report_print(&report, "pv table", f);
+	hash_report(&search->shallow_table, &report, 65536);
+	report.n_overwrite = count[2].n_overwrite; report.n_collision = count[2].n_collision;
+	hash_report_print(&report, "shallow table", f);
+}
+
+/**
+ * @brief Load the hash tables from a file.
+ *
+ * The loaded entries are kept by the next cleanups of the hash tables, which
+ * only change their date, until the date overflows or the table is resized.
+ *
+ * @param search search.
+ * @param file File name.
+ */
+void search_load_hashtable(Search *search, const char *file)
+{
+	FILE *f = fopen(file, "rb");
+
+	if (f == NULL) {
+		warn("Cannot open hash file %s\n", file);
+		return;
+	}
+	if (!hash_load(&search->hash_table, f) || !hash_load(&search->pv_table, f)) {
+		warn("Cannot load hash file %s\n", file);
+	}
+	fclose(f);
 }
 
 
@@ -838,8 +1065,9 @@ void search_check_timeout(Search *search)
  */
 void search_set_task_number(Search *search, const int n)
 {
-	assert(n > 0 && n < MAX_THREADS);
+	assert(n >= 0 && n <= MAX_THREADS);
 	task_stack_resize(search->tasks, n);
+	search_set_task(search);
 	search->allow_node_splitting = (n > 1);
 }
 
@@ -886,10 +1114,12 @@ void search_get_movelist(const Search *search, MoveList *movelist)
 	previous->next = NULL;
 }
 
-#if 0	// inlined
 /**
  * @brief Update the search state after a move.
  *
+ * Only the board, the empties & the parity are updated, as the endgame
+ * search does not use the evaluation features.
+ *
  * @param search  search.
  * @param move    played move.
  */
@@ -899,7 +1129,6 @@ void search_update_endgame(Search *search, const Move *move)
 	empty_remove(search->empties, move->x);
 	board_update(&search->board, move);
 	--search->eval.n_empties;
-
 }
 
 /**
@@ -916,6 +1145,7 @@ void search_restore_endgame(Search *search, const Move *move)
 	++search->eval.n_empties;
 }
 
+#if 0	// inlined
 /**
  * @brief Update the search state after a passing move.
  *
@@ -1044,7 +1274,7 @@ bool is_depth_solving(const int depth, const int n_empties)
  */
 long long search_clock(Search *search)
 {
-	if (options.nps > 0) return search_count_nodes(search) / options.nps;
+	if (search->options.nps > 0) return search_count_nodes(search) / search->options.nps;
 	else return time_clock();
 }
 
@@ -1071,6 +1301,22 @@ unsigned long long search_count_nodes(Search *search)
 	return search->n_nodes + search->child_nodes;
 }
 
+/**
+ * @brief Add the hash table replacements of a search.
+ *
+ * @param search  Search.
+ * @param count Replacement counts of the hash, pv & shallow tables, to add to.
+ */
+void search_count_hash(const Search *search, HashCount *count)
+{
+	int i;
+
+	for (i = 0; i < 3; ++i) {
+		count[i].n_overwrite += search->hash_count[i].n_overwrite + search->child_hash_count[i].n_overwrite;
+		count[i].n_collision += search->hash_count[i].n_collision + search->child_hash_count[i].n_collision;
+	}
+}
+
 /**
  * @brief default observer.
  *
@@ -1093,6 +1339,21 @@ void search_set_observer(Search *search, void (*observer)(Result*))
 	search->observer = observer;
 }
 
+/**
+ * @brief set root move observer.
+ *
+ * The observer is called once for each root move, as soon as its score is known.
+ *
+ * @param search Searched position.
+ * @param observer call back function to receive the root move results (or NULL).
+ * @param data data passed to the observer.
+ */
+void search_set_move_observer(Search *search, void (*observer)(const MoveResult*, void*), void *data)
+{
+	search->move_observer = observer;
+	search->move_observer_data = data;
+}
+
 /**
  * @brief Print the current search result.
  *
@@ -1260,7 +1521,8 @@ bool search_TC_NWS(HashData *data, const int depth, const int selectivity, const
  *
  * Before looping over each moves to search at next ply, ETC looks if a cutoff
  * is available from the hashtable. This version also looks for a cutoff based
- * on stability.
+ * on stability. The hash entries of all the moves are prefetched first, so
+ * that their memory accesses overlap.
  *
  * @param search Current position.
  * @param movelist List of moves for the current position.
@@ -1279,10 +1541,11 @@ bool search_ETC_NWS(Search *search, MoveList *movelist, unsigned long long hash_
 		Board next;
 		HashData etc;
 		HashStoreData hash_data;
-		unsigned long long etc_hash_code;
+		unsigned long long etc_hash_code[MAX_MOVE];
 		HashTable *hash_table = &search->hash_table;
 		const int etc_depth = depth - 1;
 		const int beta = alpha + 1;
+		int i;
 
 		hash_data.data.wl.c.depth = depth;
 		hash_data.data.wl.c.selectivity = selectivity;
@@ -1291,6 +1554,20 @@ bool search_ETC_NWS(Search *search, MoveList *movelist, unsigned long long hash_
 		hash_data.beta = beta;
 
 		CUTOFF_STATS(++statistics.n_etc_try;)
+
+		// first pass: prefetch the hash entries of all the children
+		if (USE_TC) {
+			i = 0;
+			foreach_move (move, *movelist) {
+				next.opponent = search->board.player ^ (move->flipped | x_to_bit(move->x));
+				next.player = search->board.opponent ^ move->flipped;
+				etc_hash_code[i] = board_get_hash_code(&next);
+				hash_prefetch(hash_table, etc_hash_code[i++]);
+			}
+		}
+
+		// second pass: look for a cutoff
+		i = 0;
 		foreach_move (move, *movelist) {
 			next.opponent = search->board.player ^ (move->flipped | x_to_bit(move->x));
 			next.player = search->board.opponent ^ move->flipped;
@@ -1307,8 +1584,7 @@ bool search_ETC_NWS(Search *search, MoveList *movelist, unsigned long long hash_
 				}
 			}
 
-			etc_hash_code = board_get_hash_code(&next);
-			if (USE_TC && hash_get(hash_table, &next, etc_hash_code, &etc) && etc.wl.c.selectivity >= selectivity && etc.wl.c.depth >= etc_depth) {
+			if (USE_TC && hash_get(hash_table, &next, etc_hash_code[i++], &etc) && etc.wl.c.selectivity >= selectivity && etc.wl.c.depth >= etc_depth) {
 				*score = -etc.upper;
 				if (*score > alpha) {
 					hash_data.score = *score;
@@ -18,6 +18,7 @@
 #include "eval.h"
 #include "hash.h"
 #include "move.h"
+#include "options.h"
 #include "util.h"
 
 #include <stdio.h>
@@ -32,12 +33,30 @@ typedef struct Selectivity {
 struct Task;
 struct TaskQueue;
 
+/** Settings of a search, fixed at its creation */
+typedef struct SearchConfig {
+	int n_task;                       /**< number of tasks */
+	int hash_table_size;              /**< hash table size (2^n entries) */
+	const char *hash_shared_name;     /**< shared memory name of the hash table (or NULL for a private table) */
+	ParallelMode parallel_mode;       /**< parallel search engine */
+	double nps;                       /**< simulated search speed, to count the time (0 for the real time) */
+} SearchConfig;
+
 /** Bound */
 typedef struct Bound {
 	int lower;
 	int upper;
 } Bound;
 
+/** Entry of the endgame cache: an exact position with its score bounds */
+typedef struct EndCacheEntry {
+	unsigned long long player;   /**< player's discs (solid normalized) */
+	unsigned long long opponent; /**< opponent's discs (solid normalized) */
+	signed char lower;           /**< lower bound of the score */
+	signed char upper;           /**< upper bound of the score */
+	unsigned char move;          /**< best move */
+} EndCacheEntry;
+
 /** Result */
 typedef struct Result {
 	int depth;                   /**< searched depth */
@@ -48,12 +67,23 @@ typedef struct Result {
 	Line pv;                     /**< principal variation */
 	long long time;              /**< searched time */
 	unsigned long long n_nodes;  /**< searched node count */
+	int hash_full;               /**< main hash table entries of the current date (permille) */
 	bool book_move;              /**< book move origin */
 	int n_moves;                 /**< total moves to search */
 	int n_moves_left;            /**< left moves to search */
 	SpinLock spin;
 } Result;
 
+/** Result of a single root move */
+typedef struct MoveResult {
+	int move;                    /**< root move */
+	int score;                   /**< score of the move */
+	Bound bound;                 /**< score bounds of the move */
+	int depth;                   /**< searched depth */
+	int selectivity;             /**< searched selectivity */
+	Line pv;                     /**< principal variation starting with the move */
+} MoveResult;
+
 /** levels */
 extern struct Level {
 	unsigned char depth;         /** search depth */
@@ -65,31 +95,37 @@ extern struct Level {
 typedef struct Search {
 	Board board;                                  /**< othello board (16) */
 
-	volatile unsigned long long n_nodes;          /**< node counter (8) */
-	volatile unsigned long long child_nodes;      /**< node counter (8) */
+	unsigned long long n_nodes;                   /**< node counter, only updated by the thread running the search (8) */
+	HashCount hash_count[3];                      /**< replacements in the hash, pv & shallow tables by this thread (48) */
 
 	Eval eval;                                    /**< eval */
 
 	SquareList empties[BOARD_SIZE + 2];           /**< list of empty squares */
 	int player;                                   /**< player color */
 	int id;                                       /**< search id */
+	int helper;                                   /**< lazy smp helper number (0 for the main search) */
 
 	HashTable hash_table;                         /**< hashtable */
 	HashTable pv_table;                           /**< hashtable for the pv */
 	HashTable shallow_table;                      /**< hashtable for short search */
+	EndCacheEntry *end_cache;                     /**< thread-local endgame cache */
 	Random random;                                /**< random generator */
 
 	struct TaskStack *tasks;                      /**< available task queue */
 	struct Task *task;                            /**< search task */
 	SpinLock spin;                                /**< search lock */
+	volatile unsigned long long child_nodes;      /**< node count of the finished child searches (updated under lock) */
+	HashCount child_hash_count[3];                /**< hash table replacements of the finished child searches (updated under lock) */
 	struct Search *parent;                        /**< parent search */
-	struct Search *child[MAX_THREADS];            /**< child search */
+	struct Search **child;                        /**< child search */
 	struct Search *master;                        /**< master search (parent of all searches)*/
 	volatile int n_child;                         /**< search child number */
+	int n_child_max;                              /**< size of the child array */
+	struct Search *help_search;                   /**< search of the helper task of its waiting node (reused) */
+	EventCount helper_event;                      /**< signalled when a lazy smp helper of the main search ends */
 
 	int depth;                                    /**< depth level */
 	int selectivity;                              /**< selectivity level */
-	int probcut_level;                            /**< probcut recursivity level */
 	int depth_pv_extension;                       /**< depth for pv_extension */
 	volatile Stop stop;                           /**< thinking status */
 	bool allow_node_splitting;                    /**< allow parallelism */
@@ -103,6 +139,7 @@ typedef struct Search {
 	} time;                                       /**< time */
 	MoveList movelist;                            /**< list of moves */
 	int height;                                   /**< search height from root */
+	int probcut_level;                            /**< probcut recursivity level */
 	NodeType node_type[GAME_SIZE];                /**< node type (pv node, cut node, all node) */
 	Bound stability_bound;                        /**< score bounds according to stable squares */
 
@@ -118,11 +155,17 @@ typedef struct Search {
 		bool guess_pv;                            /**< guess PV (in cassio mode only) */
 		int multipv_depth;                        /**< multi PV depth */
 		int hash_size;                            /**< hashtable size */
+		ParallelMode parallel_mode;               /**< parallel search engine */
+		double nps;                               /**< simulated search speed (0 for the real time) */
+		int alpha;                                /**< lower bound of the root window */
+		int beta;                                 /**< upper bound of the root window */
 	} options;                                    /**< local (threadable) options. */
 
 	Result *result;                               /**< shared result */
 
 	void (*observer)(Result*);                    /**< call back function to print search result */
+	void (*move_observer)(const MoveResult*, void*); /**< call back function to stream root move results */
+	void *move_observer_data;                     /**< data passed to the root move observer */
 } Search;
 
 struct Node;
@@ -137,11 +180,18 @@ extern const unsigned char SQUARE_TYPE[];
 
 /* function definition */
 void search_global_init(void);
+void search_config_init(SearchConfig*);
 void search_init(Search*);
+void search_init_config(Search*, const SearchConfig*);
 void search_free(Search*);
 void search_cleanup(Search*);
+void search_save_hashtable(Search*, const char*);
+void search_load_hashtable(Search*, const char*);
+void search_report_hashtable(Search*, FILE*);
 void search_setup(Search*);
+void search_attach(Search*, Search*);
 void search_clone(Search*, Search*);
+void search_resize_child(Search*, const int);
 void search_set_board(Search*, const Board*, const int);
 void search_set_level(Search*, const int, const int);
 void search_set_ponder_level(Search*, const int, const int);
@@ -159,8 +209,8 @@ void search_set_task_number(Search*, const int);
 
 void search_swap_parity(Search*, const int);
 void search_get_movelist(const Search*, MoveList*);
-// void search_update_endgame(Search*, const Move*);
-// void search_restore_endgame(Search*, const Move*);
+void search_update_endgame(Search*, const Move*);
+void search_restore_endgame(Search*, const Move*);
 // void search_pass_endgame(Search*);
 void search_update_midgame(Search*, const Move*);
 void search_restore_midgame(Search*, int, const Eval*);
@@ -169,6 +219,7 @@ void search_restore_pass_midgame(Search*, const Eval*);
 long long search_clock(Search*);
 long long search_time(Search*);
 unsigned long long search_count_nodes(Search*);
+void search_count_hash(const Search*, HashCount*);
 void search_print_pv(Search*, const int, const char*, FILE*);
 void search_print(Search*, const int, const int, const char, FILE*);
 int get_pv_extension(const int, const int);
@@ -188,7 +239,9 @@ NodeType next_node_type(const NodeType parent, const bool first_move);
 int board_solve(const unsigned long long, const int);
 int search_solve(const Search*);
 int search_solve_0(const Search*);
-int NWS_endgame(Search*, const int);
+int NWS_endgame(Search*, const int, struct Node*);
+void endcache_init(Search*);
+void endcache_free(Search*);
 
 int search_eval_0(Search*);
 int search_eval_1(Search*, int, int, unsigned long long);
@@ -200,16 +253,21 @@ int PVS_shallow(Search*, int, int, int);
 
 bool is_pv_ok(Search*, int, int);
 void record_best_move(Search*, const Move*, const int, const int, const int);
+void record_root_move(Search*, const Move*, const int, const int, const int);
+void search_get_move_pv(Search*, const Move*, Line*);
 int PVS_root(Search*, const int, const int, const int);
 int aspiration_search(Search*, int, int, const int, int);
 void iterative_deepening(Search*, int, int);
+Result* search_run_window(Search*, const int, const int);
 void* search_run(void*);
+void search_run_helper(Search*);
 int search_guess(Search*, const Board*);
 void search_stop_all(Search*, const Stop);
 void search_set_state(Search*, const Stop);
 
 void search_observer(Result*);
 void search_set_observer(Search*, void (*Observer)(Result*));
+void search_set_move_observer(Search*, void (*Observer)(const MoveResult*, void*), void*);
 
 void search_share(const Search*, Search*);
 int search_count_tasks(const Search *);
@@ -71,6 +71,20 @@
   #endif
 #endif
 
+/** Quantized 8-bit evaluation weights (smaller cache footprint, slightly less accurate evaluation) */
+#ifndef EVAL_Q8
+#define EVAL_Q8 0
+#endif
+
+/** Evaluation with 512-bit vectors (16-lane gathers, 512-bit feature update) */
+#ifndef EVAL_AVX512
+  #if defined(__AVX512BW__) && defined(AVX512_PREFER512)
+	#define EVAL_AVX512 1
+  #else
+	#define EVAL_AVX512 0
+  #endif
+#endif
+
 /** transposition cutoff usage. */
 #define USE_TC true
 
@@ -117,11 +131,20 @@
 #endif
 
 /** Hash-n-way. */
+#ifndef HASH_N_WAY
 #define HASH_N_WAY 4
+#endif
 
 /** hash align */
 #define HASH_ALIGNED 1
 
+/** Lockless hash table, instead of locked whole board entries:
+ *  1: 16-byte entries verified by hash code ^ data,
+ *  2: compact 8-byte entries, a 22-bit key and the packed data in a single word. */
+#ifndef USE_HASH_LOCKLESS
+#define USE_HASH_LOCKLESS 0
+#endif
+
 /** PV extension (solve PV alone sooner) */
 #define USE_PV_EXTENSION true
 
@@ -143,18 +166,41 @@
 /** Dogaishi hash reduction Depth (before DEPTH_TO_SHALLOW_SEARCH) */
 #define MASK_SOLID_DEPTH 9
 
+/** Thread-local endgame cache: log2 of its entry count (24-byte entries, about the size of a L2 cache) */
+#ifndef ENDCACHE_SIZE
+#define ENDCACHE_SIZE 14
+#endif
+
+/** Use the endgame cache instead of the main hashtable from this number of empties (MASK_SOLID_DEPTH at most)... */
+#define ENDCACHE_MAX_DEPTH 9
+
+/** ... down to this number of empties. */
+#define ENDCACHE_MIN_DEPTH 5
+
 /** bound for usefull move sorting */
 #define SORT_ALPHA_DELTA 8
 
 /** Try Node splitting (for parallel search) down to that depth. */
 #define SPLIT_MIN_DEPTH 5
 
+/** Try endgame Node splitting (for parallel search) down to that number of empties. */
+#define SPLIT_MIN_ENDGAME_DEPTH 11
+
 /** Stop Node splitting (for parallel search) when few move remains.  */
 #define SPLIT_MIN_MOVES_TODO 1
 
 /** Stop Node splitting (for parallel search) after a few splitting.  */
 #define SPLIT_MAX_SLAVES 3
 
+/** Maximal number of split points published by a task (work stealing). */
+#define SPLIT_DEQUE_SIZE 64
+
+/** Idle task attempts to steal a split point before going to sleep (work stealing). */
+#define SPLIT_STEAL_TRY 64
+
+/** Spin loops of an idle thread before it goes to sleep (for parallel search). */
+#define IDLE_SPIN 4000
+
 /** Branching factor (to adjust alloted time). */
 #define BRANCHING_FACTOR 2.24
 
@@ -33,6 +33,8 @@ void statistics_init(void)
 	statistics.n_hash_remove = 0;
 	statistics.n_hash_search = 0;
 	statistics.n_hash_found = 0;
+	statistics.n_hash_found_first = 0;
+	statistics.n_hash_demote = 0;
 	statistics.n_hash_collision = 0;
 	statistics.n_hash_n = 0;
 
@@ -49,6 +51,8 @@ void statistics_init(void)
 	statistics.n_stopped_master = 0;
 	statistics.n_waited_slave = 0;
 	statistics.n_wake_up = 0;
+	statistics.n_wake_spin = statistics.n_wake_sleep = 0;
+	statistics.t_wake_spin = statistics.t_wake_sleep = 0;
 
 	statistics.n_PVS_root = 0;
 	statistics.n_PVS_midgame = 0;
@@ -68,6 +72,9 @@ void statistics_init(void)
 	statistics.n_hash_try = 0;
 	statistics.n_hash_low_cutoff = 0;
 	statistics.n_hash_high_cutoff = 0;
+	statistics.n_endcache_try = 0;
+	statistics.n_endcache_low_cutoff = 0;
+	statistics.n_endcache_high_cutoff = 0;
 	statistics.n_stability_try = 0;
 	statistics.n_stability_low_cutoff = 0;
 	statistics.n_probcut_try = 0;
@@ -123,6 +130,8 @@ void statistics_print(FILE *f)
 		fprintf(f, "slave nodes stopped: %12llu (%6.2f%%)\n", statistics.n_stopped_slave, 100.0 * statistics.n_stopped_slave / statistics.n_split_success);
 		fprintf(f, "slave master stopped:%12llu (%6.2f%%) = %12llu\n", statistics.n_stopped_master, 100.0 * statistics.n_stopped_master / statistics.n_split_success, statistics.n_wake_up);
 		fprintf(f, "slave nodes waited:  %12llu (%6.2f%%)\n", statistics.n_waited_slave, 100.0 * statistics.n_waited_slave / statistics.n_split_success);
+		fprintf(f, "wake-ups spinning:   %12llu (%8.0f ns)\n", statistics.n_wake_spin, (double) statistics.t_wake_spin / (statistics.n_wake_spin + !statistics.n_wake_spin));
+		fprintf(f, "wake-ups sleeping:   %12llu (%8.0f ns)\n", statistics.n_wake_sleep, (double) statistics.t_wake_sleep / (statistics.n_wake_sleep + !statistics.n_wake_sleep));
 		fprintf(f, "main thread (%llu nodes)\n", statistics.n_nodes);
 		for (i = 1; i < options.n_task; ++i) {
 			fprintf(f, "task %d called %llu times (%llu nodes)\n", i, statistics.n_task[i], statistics.n_task_nodes[i]);
@@ -154,6 +163,7 @@ void statistics_print(FILE *f)
 		fprintf(f, "Probe: %llu   found: %llu (%6.2f%%)\n", statistics.n_hash_search, statistics.n_hash_found, 100.0 * statistics.n_hash_found / statistics.n_hash_search);
 		fprintf(f, "New: %llu   Update: %llu   Ugrade: %llu   Remove: %llu\n",
 			statistics.n_hash_new, statistics.n_hash_update, statistics.n_hash_upgrade, statistics.n_hash_remove);
+		fprintf(f, "Found in first way: %llu (%6.2f%%)   Demote: %llu\n", statistics.n_hash_found_first, 100.0 * statistics.n_hash_found_first / statistics.n_hash_found, statistics.n_hash_demote);
 	}
 
 	if (statistics.n_hash_n) {
@@ -179,6 +189,13 @@ void statistics_print(FILE *f)
 				statistics.n_hash_low_cutoff, 100.0 * statistics.n_hash_low_cutoff / statistics.n_hash_try,
 				statistics.n_hash_high_cutoff, 100.0 * statistics.n_hash_high_cutoff / statistics.n_hash_try);
 		}
+		if (statistics.n_endcache_try) {
+			fprintf(f, "Endgame cache cutoff:\n");
+			fprintf(f, "try = %llu, low cutoff = %llu (%6.2f%%), high cutoff = %llu (%6.2f%%)\n",
+				statistics.n_endcache_try,
+				statistics.n_endcache_low_cutoff, 100.0 * statistics.n_endcache_low_cutoff / statistics.n_endcache_try,
+				statistics.n_endcache_high_cutoff, 100.0 * statistics.n_endcache_high_cutoff / statistics.n_endcache_try);
+		}
 		if (statistics.n_stability_try) {
 			fprintf(f, "Stability cutoff:\n");
 			fprintf(f, "try = %llu, low cutoff = %llu (%6.2f%%)\n",
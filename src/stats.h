@@ -72,6 +72,8 @@ typedef struct Statistics {
 	unsigned long long n_hash_remove;
 	unsigned long long n_hash_search;
 	unsigned long long n_hash_found;
+	unsigned long long n_hash_found_first;
+	unsigned long long n_hash_demote;
 	unsigned long long n_hash_collision;
 	unsigned long long n_hash_n;
 
@@ -101,8 +103,11 @@ typedef struct Statistics {
 	unsigned long long n_stopped_slave;
 	unsigned long long n_stopped_master;
 	unsigned long long n_wake_up;
+	unsigned long long n_wake_spin, n_wake_sleep;
+	unsigned long long t_wake_spin, t_wake_sleep;
 
 	unsigned long long n_hash_try, n_hash_low_cutoff, n_hash_high_cutoff;
+	unsigned long long n_endcache_try, n_endcache_low_cutoff, n_endcache_high_cutoff;
 	unsigned long long n_stability_try, n_stability_low_cutoff;
 	unsigned long long n_probcut_try;
 	unsigned long long n_probcut_low_try, n_probcut_low_cutoff;
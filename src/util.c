@@ -36,13 +36,17 @@
 #include <sys/time.h>
 #include <sys/resource.h>
 #include <sys/stat.h>
+#include <sched.h>
 
 #endif // __unix__ || __APPLE__
 
 #if defined(__linux__)
 
 #include <sys/sysinfo.h>
-#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <fcntl.h>
 
 #endif // __linux__
 
@@ -98,6 +102,25 @@ long long cpu_clock(void)
 	return 1000 * u.ru_utime.tv_sec + u.ru_utime.tv_usec / 1000;
 }
 
+/**
+ * @brief nano_clock
+ *
+ * Measure wall clock time with a fine resolution.
+ * @return time in nanoseconds.
+ */
+long long nano_clock(void)
+{
+#if _POSIX_TIMERS > 0
+	struct timespec tv;
+	clock_gettime(CLOCK_MONOTONIC, &tv);
+	return tv.tv_sec * 1000000000LL + tv.tv_nsec;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000000LL + tv.tv_usec * 1000LL;
+#endif
+}
+
 #elif defined (_WIN32)
 
 long long real_clock(void)
@@ -110,6 +133,14 @@ long long cpu_clock(void)
 	return GetTickCount();
 }
 
+long long nano_clock(void)
+{
+	LARGE_INTEGER t, f;
+	QueryPerformanceCounter(&t);
+	QueryPerformanceFrequency(&f);
+	return (long long) ((double) t.QuadPart * 1e9 / f.QuadPart);
+}
+
 #endif
 
 /**
@@ -956,6 +987,19 @@ void thread_join(Thread thread)
 	CloseHandle(thread);
 #endif
 }
+
+/**
+ * @brief Yield the processor to another thread.
+ */
+void thread_yield(void)
+{
+#if defined(__unix__) || (defined(_WIN32) && defined(USE_PTHREAD)) || defined(__APPLE__)
+	sched_yield();
+#elif defined(_WIN32)
+	SwitchToThread();
+#endif
+}
+
 /**
  * @brief Current thread.
  *
@@ -971,16 +1015,250 @@ Thread thread_self(void)
 }
 
 /**
- * @brief Choose a single core or cpu to run on, under linux systems, to avoid
- * context changes
+ * @brief Initialize an event count.
+ *
+ * @param event Event count.
+ */
+void eventcount_init(EventCount *event)
+{
+	event->seq = 0;
+	event->n_sleeper = 0;
+#if !defined(__linux__)
+	lock_init(event);
+	condition_init(event);
+#endif
+}
+
+/**
+ * @brief Free an event count.
+ *
+ * @param event Event count.
+ */
+void eventcount_free(EventCount *event)
+{
+#if defined(__linux__)
+	(void) event;
+#else
+	lock_free(event);
+	condition_free(event);
+#endif
+}
+
+/**
+ * @brief Wait for an event count to be signalled.
+ *
+ * The thread spins for a while first, as the signal often comes soon, and
+ * then sleeps, on a futex under Linux.
+ *
+ * @param event Event count.
+ * @param key Key taken before checking the wake-up condition.
+ * @param spin Number of spin loops before sleeping.
+ * @return true if the thread has slept, false if the signal came while spinning.
+ */
+bool eventcount_wait(EventCount *event, const int key, int spin)
+{
+	bool slept = false;
+
+	for (; spin > 0; --spin) {
+		if (event->seq != key) return false;
+		cpu_pause();
+	}
+
+	atomic_add_int(&event->n_sleeper, 1);
+#if defined(__linux__)
+	while (event->seq == key) {
+		syscall(SYS_futex, &event->seq, FUTEX_WAIT_PRIVATE, key, NULL, NULL, 0);
+		slept = true;
+	}
+#else
+	lock(event);
+	while (event->seq == key) {
+		condition_wait(event);
+		slept = true;
+	}
+	unlock(event);
+#endif
+	atomic_add_int(&event->n_sleeper, -1);
+
+	return slept;
+}
+
+/**
+ * @brief Signal an event count, waking up its waiting threads.
+ *
+ * No system call is made when no thread sleeps.
+ *
+ * @param event Event count.
+ */
+void eventcount_signal(EventCount *event)
+{
+	atomic_add_int(&event->seq, 1);
+	if (event->n_sleeper) {
+#if defined(__linux__)
+		syscall(SYS_futex, &event->seq, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#else
+		lock(event);
+		condition_broadcast(event);
+		unlock(event);
+#endif
+	}
+}
+
+#if defined(__linux__) && defined(CPU_SET)
+
+/** Cpu topology */
+typedef struct CpuTopology {
+	int cpu;     /**< cpu (logical processor) number */
+	int smt;     /**< rank of the cpu within its physical core */
+	int node;    /**< NUMA node */
+	int package; /**< physical package (socket) */
+	int l3;      /**< L3 cache (core complex) */
+	int core;    /**< physical core within its package */
+} CpuTopology;
+
+/** cpus to run the tasks on, in placement order */
+static int cpu_order[MAX_THREADS];
+static int n_cpu_order = 0;
+
+/**
+ * @brief Read an integer from a linux sysfs file.
+ *
+ * @param file File name format, with an integer argument.
+ * @param i Integer argument of the file name.
+ * @param value Default value.
+ * @return the read value, or the default one if the file is missing.
+ */
+static int sysfs_read_int(const char *file, const int i, int value)
+{
+	char name[128];
+	FILE *f;
+	int x;
+
+	sprintf(name, file, i);
+	f = fopen(name, "r");
+	if (f != NULL) {
+		if (fscanf(f, "%d", &x) == 1) value = x;
+		fclose(f);
+	}
+	return value;
+}
+
+/**
+ * @brief Read a linux sysfs list of numbers, like "0-3,8-11".
+ *
+ * @param file File name.
+ * @param set Array set to value at each listed number.
+ * @param n Size of the array.
+ * @param value Value to set.
+ * @return true if the list was read, false otherwise.
+ */
+static bool sysfs_read_list(const char *file, int *set, const int n, const int value)
+{
+	char line[1024], *s, *end;
+	long first, last;
+	FILE *f = fopen(file, "r");
+
+	if (f == NULL) return false;
+	if (fgets(line, sizeof (line), f) != NULL) {
+		for (s = line; *s; s = end) {
+			first = last = strtol(s, &end, 10);
+			if (end == s) break;
+			if (*end == '-') last = strtol(end + 1, &end, 10);
+			for (; first <= last && first < n; ++first) set[first] = value;
+			if (*end == ',') ++end;
+		}
+	}
+	fclose(f);
+	return true;
+}
+
+/**
+ * @brief Compare two cpus for placement.
+ *
+ * One thread per physical core first, filling a NUMA node, then a package
+ * and an L3 cache before the next ones; SMT siblings come last.
+ */
+static int cpu_topology_compare(const void *a, const void *b)
+{
+	const CpuTopology *x = (const CpuTopology*) a;
+	const CpuTopology *y = (const CpuTopology*) b;
+
+	if (x->smt != y->smt) return x->smt - y->smt;
+	if (x->node != y->node) return x->node - y->node;
+	if (x->package != y->package) return x->package - y->package;
+	if (x->l3 != y->l3) return x->l3 - y->l3;
+	if (x->core != y->core) return x->core - y->core;
+	return x->cpu - y->cpu;
+}
+
+/**
+ * @brief Order the cpus the process is allowed to run on, from the topology
+ * found in the linux sysfs.
+ *
+ * Called once by cpu_init(), before any thread is pinned.
+ */
+static void cpu_topology_init(void)
+{
+	static int node[CPU_SETSIZE];
+	static CpuTopology topology[CPU_SETSIZE];
+	unsigned long long nodes = get_numa_node_mask();
+	cpu_set_t allowed;
+	char file[64];
+	int i, j, n;
+
+	if (sched_getaffinity(0, sizeof (allowed), &allowed) != 0) {
+		CPU_ZERO(&allowed);
+		for (i = 0; i < get_cpu_number() && i < CPU_SETSIZE; ++i) CPU_SET(i, &allowed);
+	}
+
+	for (i = 0; i < CPU_SETSIZE; ++i) node[i] = 0;
+	foreach_bit(i, nodes) {
+		sprintf(file, "/sys/devices/system/node/node%d/cpulist", i);
+		sysfs_read_list(file, node, CPU_SETSIZE, i);
+	}
+
+	for (i = n = 0; i < CPU_SETSIZE && n < MAX_THREADS; ++i) {
+		if (CPU_ISSET(i, &allowed)) {
+			topology[n].cpu = i;
+			topology[n].node = node[i];
+			topology[n].package = sysfs_read_int("/sys/devices/system/cpu/cpu%d/topology/physical_package_id", i, 0);
+			topology[n].core = sysfs_read_int("/sys/devices/system/cpu/cpu%d/topology/core_id", i, i);
+			topology[n].l3 = sysfs_read_int("/sys/devices/system/cpu/cpu%d/cache/index3/id", i, topology[n].package);
+			for (topology[n].smt = j = 0; j < n; ++j) {
+				if (topology[j].package == topology[n].package && topology[j].core == topology[n].core) ++topology[n].smt;
+			}
+			++n;
+		}
+	}
+	if (n == 0) topology[n++].cpu = 0;
+
+	qsort(topology, n, sizeof (CpuTopology), cpu_topology_compare);
+	for (i = 0; i < n; ++i) cpu_order[i] = topology[i].cpu;
+	n_cpu_order = n;
+}
+
+#endif
+
+/**
+ * @brief Choose a single core or cpu to run on, to avoid context changes.
+ *
+ * Under linux, the i-th thread does not simply run on the i-th cpu, but
+ * follows the topology of the machine: threads are first spread over the
+ * physical cores, the cores of a same NUMA node and L3 cache being used
+ * together, and SMT siblings are used last, once all the cores are busy.
+ *
+ * @param thread Thread.
+ * @param i Thread number.
  */
 void thread_set_cpu(Thread thread, int i)
 {
 #if defined(__linux__) && defined(CPU_SET)
 	cpu_set_t cpu;
 
+	if (n_cpu_order == 0) return;	// cpu_init() not called
+
 	CPU_ZERO(&cpu);
-	CPU_SET(i, &cpu);
+	CPU_SET(cpu_order[i % n_cpu_order], &cpu);
 	pthread_setaffinity_np(thread, sizeof (cpu_set_t), &cpu);
 #elif defined(_WIN32) && !defined(USE_PTHREAD)
 	SetThreadIdealProcessor(thread, i);
@@ -989,12 +1267,39 @@ void thread_set_cpu(Thread thread, int i)
 #endif
 }
 
+/**
+ * @brief Let a thread run again on any of the cpus the process is allowed to.
+ *
+ * @param thread Thread.
+ */
+void thread_unset_cpu(Thread thread)
+{
+#if defined(__linux__) && defined(CPU_SET)
+	cpu_set_t cpu;
+	int i;
+
+	if (n_cpu_order > 0) {	// else, no thread has been pinned
+		CPU_ZERO(&cpu);
+		for (i = 0; i < n_cpu_order; ++i) CPU_SET(cpu_order[i], &cpu);
+		pthread_setaffinity_np(thread, sizeof (cpu_set_t), &cpu);
+	}
+#else
+	(void) thread;
+#endif
+}
+
+/** number of cpus, counted once (see cpu_init()) */
+static int n_cpu = 0;
 
 /**
- * @brief Get the number of cpus or cores on the machine.
+ * @brief Count the cpus or cores on the machine.
+ *
+ * Under linux, the cpus the calling thread is allowed to run on are counted:
+ * call it before any thread is pinned to a single cpu.
+ *
  * @return Cpu/Core number
  */
-int get_cpu_number(void)
+static int cpu_count(void)
 {
 	int n = 0;
 
@@ -1011,10 +1316,21 @@ int get_cpu_number(void)
 		fclose(f);
 	}
 
+#elif defined(__linux__) && defined(CPU_COUNT)
+
+	cpu_set_t allowed;
+
+	if (sched_getaffinity(0, sizeof (allowed), &allowed) == 0) n = CPU_COUNT(&allowed);	// cpus not excluded by taskset or cgroups
+	else n = sysconf(_SC_NPROCESSORS_ONLN);
+
 #elif defined(_SC_NPROCESSORS_ONLN)
 
 	n = sysconf(_SC_NPROCESSORS_ONLN);
 
+#elif defined(_WIN32) && defined(ALL_PROCESSOR_GROUPS)
+
+	n = GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);	// beyond the 64 cpus of a processor group
+
 #elif defined(_WIN32)
 
 	SYSTEM_INFO info;
@@ -1042,6 +1358,289 @@ int get_cpu_number(void)
 	return n;
 }
 
+/**
+ * @brief Count the cpus and order them for the threads.
+ *
+ * Call it once at startup, before any thread is pinned to a cpu (see
+ * thread_set_cpu()), as the affinity of a pinned thread hides the other cpus.
+ */
+void cpu_init(void)
+{
+	n_cpu = cpu_count();
+#if defined(__linux__) && defined(CPU_SET)
+	cpu_topology_init();
+#endif
+}
+
+/**
+ * @brief Get the number of cpus or cores on the machine.
+ *
+ * The number is counted by cpu_init() at startup, whatever the cpu the
+ * calling thread is pinned to.
+ *
+ * @return Cpu/Core number
+ */
+int get_cpu_number(void)
+{
+	if (n_cpu == 0) n_cpu = cpu_count();	// cpu_init() not called
+	return n_cpu;
+}
+
+/**
+ * @brief Get the NUMA nodes of the machine.
+ *
+ * Only the first 64 nodes are reported.
+ * @return a bitmask of the online NUMA nodes (1 if unknown).
+ */
+unsigned long long get_numa_node_mask(void)
+{
+	unsigned long long mask = 0;
+
+#if defined(__linux__) && defined(CPU_SET)
+	int online[64] = {0}, i;
+
+	if (sysfs_read_list("/sys/devices/system/node/online", online, 64, 1)) {	// "0-1,3"
+		for (i = 0; i < 64; ++i) if (online[i]) mask |= 1ULL << i;
+	}
+#endif
+
+	if (mask == 0) mask = 1;
+
+	return mask;
+}
+
+/**
+ * @brief Allocate a large memory block.
+ *
+ * Under linux, huge pages are tried first: 1GB pages (if not too much memory
+ * is wasted), then 2MB pages from the hugetlbfs pool, and finally transparent
+ * huge pages. The memory may also be interleaved over the NUMA nodes. If all
+ * of this is not requested or fails, the memory is allocated with malloc().
+ *
+ * @param size Size in bytes.
+ * @param huge_pages Try to use huge pages.
+ * @param interleave Interleave the memory over the NUMA nodes.
+ * @param mapped Output: size of the memory mapping, or 0 if allocated by malloc().
+ * @return Allocated memory, or NULL.
+ */
+void* large_alloc(const size_t size, const bool huge_pages, const bool interleave, size_t *mapped)
+{
+#if defined(__linux__) && defined(MAP_ANONYMOUS)
+	const size_t MB2 = (size_t) 1 << 21;
+	void *p = MAP_FAILED;
+	size_t n = 0;
+	const char *kind = "4KB pages";
+	unsigned long node_mask;
+
+	if ((huge_pages || interleave) && size >= MB2) {
+	#if defined(MAP_HUGETLB)
+		if (huge_pages) {
+		#if defined(MAP_HUGE_1GB)
+			const size_t GB1 = (size_t) 1 << 30;
+			n = (size + GB1 - 1) & ~(GB1 - 1);
+			if (size >= GB1 && n - size <= size / 8) {
+				p = mmap(NULL, n, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_1GB, -1, 0);
+				kind = "1GB huge pages";
+			}
+		#endif
+			if (p == MAP_FAILED) {
+				n = (size + MB2 - 1) & ~(MB2 - 1);
+				p = mmap(NULL, n, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+				kind = "2MB huge pages";
+			}
+		}
+	#endif
+		if (p == MAP_FAILED) {
+			n = (size + MB2 - 1) & ~(MB2 - 1);
+			p = mmap(NULL, n, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			kind = "4KB pages";
+	#if defined(MADV_HUGEPAGE)
+			if (p != MAP_FAILED && huge_pages && madvise(p, n, MADV_HUGEPAGE) == 0) kind = "transparent huge pages";
+	#endif
+		}
+
+		if (p != MAP_FAILED) {
+			info("<large memory: %zu bytes with %s>\n", n, kind);
+			node_mask = (unsigned long) get_numa_node_mask();
+			if (interleave && (node_mask & (node_mask - 1))) {
+	#if defined(SYS_mbind)
+				// mbind(p, n, MPOL_INTERLEAVE, &node_mask, maxnode, 0), without libnuma
+				if (syscall(SYS_mbind, p, n, 3, &node_mask, 8 * sizeof (node_mask) + 1, 0) == 0) info("<large memory: interleaved over NUMA nodes %#lx>\n", node_mask);
+				else info("<large memory: NUMA interleave failed>\n");
+	#endif
+			}
+			*mapped = n;
+			return p;
+		}
+	}
+#else
+	(void) huge_pages; (void) interleave;
+#endif
+
+	*mapped = 0;
+	return malloc(size);
+}
+
+/**
+ * @brief Map a named shared memory block.
+ *
+ * The block is a POSIX shared memory object, created zero-filled by the first
+ * process and mapped as is by the next ones. The object outlives the processes,
+ * until removed by shared_unlink(), or from /dev/shm. An existing object of
+ * another size is not used.
+ *
+ * @param name Name of the shared memory object.
+ * @param size Size in bytes.
+ * @param mapped Output: size of the memory mapping.
+ * @param created Output: true if the object has been created.
+ * @return Mapped memory, or NULL.
+ */
+void* shared_alloc(const char *name, const size_t size, size_t *mapped, bool *created)
+{
+#if defined(__linux__) && defined(MAP_ANONYMOUS) && !defined(ANDROID)	// no POSIX shared memory in bionic
+	char path[FILENAME_MAX];
+	const size_t n = (size + 4095) & ~(size_t) 4095;
+	struct stat st;
+	void *p;
+	int fd, i;
+
+	snprintf(path, sizeof (path), "%s%s", (*name == '/') ? "" : "/", name);
+	*created = true;
+	fd = shm_open(path, O_RDWR | O_CREAT | O_EXCL, 0666);
+	if (fd >= 0) {
+		if (ftruncate(fd, n) != 0) {
+			warn("shared memory %s: cannot set its size to %zu bytes\n", path, n);
+			close(fd);
+			shm_unlink(path);
+			return NULL;
+		}
+	} else if (errno == EEXIST) {
+		*created = false;
+		fd = shm_open(path, O_RDWR, 0666);
+		if (fd < 0) {
+			warn("shared memory %s: cannot open it\n", path);
+			return NULL;
+		}
+		for (i = 0; i < 100 && fstat(fd, &st) == 0 && st.st_size == 0; ++i) relax(10);	// the creator has not set the size yet
+		if (fstat(fd, &st) != 0 || (size_t) st.st_size != n) {
+			warn("shared memory %s: size mismatch (%lld bytes instead of %zu)\n", path, (long long) st.st_size, n);
+			close(fd);
+			return NULL;
+		}
+	} else {
+		warn("shared memory %s: cannot create it\n", path);
+		return NULL;
+	}
+
+	p = mmap(NULL, n, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED) {
+		warn("shared memory %s: cannot map it\n", path);
+		if (*created) shm_unlink(path);
+		return NULL;
+	}
+	info("<shared memory %s: %zu bytes %s>\n", path, n, *created ? "created" : "attached");
+	*mapped = n;
+	return p;
+#else
+	(void) name; (void) size; (void) mapped; (void) created;
+	warn("shared memory is not supported on this system\n");
+	return NULL;
+#endif
+}
+
+/**
+ * @brief Remove a named shared memory block.
+ *
+ * The processes that mapped the block keep it until they unmap it, but new
+ * processes will create a new block.
+ *
+ * @param name Name of the shared memory object.
+ */
+void shared_unlink(const char *name)
+{
+#if defined(__linux__) && defined(MAP_ANONYMOUS) && !defined(ANDROID)
+	char path[FILENAME_MAX];
+
+	snprintf(path, sizeof (path), "%s%s", (*name == '/') ? "" : "/", name);
+	if (shm_unlink(path) == 0) {
+		info("<shared memory %s: removed>\n", path);
+	}
+#else
+	(void) name;
+#endif
+}
+
+/**
+ * @brief Map a file read-only.
+ *
+ * Under linux, the file is mapped in memory, so that all the processes mapping
+ * the same file share its pages through the page cache. Elsewhere, or if the
+ * mapping fails, the file is read into allocated memory.
+ *
+ * @param file File name.
+ * @param size Output: size of the file.
+ * @param mapped Output: size of the memory mapping, or 0 if allocated by malloc().
+ * @return The file content, to be freed by large_free(), or NULL.
+ */
+void* file_map(const char *file, size_t *size, size_t *mapped)
+{
+	FILE *f;
+	void *p;
+	long n;
+
+#if defined(__linux__) && defined(MAP_ANONYMOUS)
+	struct stat st;
+	int fd;
+
+	fd = open(file, O_RDONLY);
+	if (fd < 0) return NULL;
+	if (fstat(fd, &st) == 0 && st.st_size > 0) {
+		p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (p != MAP_FAILED) {
+			close(fd);
+			*size = *mapped = st.st_size;
+			return p;
+		}
+	}
+	close(fd);
+#endif
+
+	f = fopen(file, "rb");
+	if (f == NULL) return NULL;
+	p = NULL;
+	if (fseek(f, 0, SEEK_END) == 0 && (n = ftell(f)) > 0 && fseek(f, 0, SEEK_SET) == 0) {
+		p = malloc(n);
+		if (p && fread(p, 1, n, f) != (size_t) n) {
+			free(p);
+			p = NULL;
+		}
+		*size = n;
+	}
+	fclose(f);
+	*mapped = 0;
+	return p;
+}
+
+/**
+ * @brief Free a large memory block.
+ *
+ * @param p Memory allocated by large_alloc(), shared_alloc() or file_map().
+ * @param mapped Size of the memory mapping, as returned by large_alloc(), shared_alloc() or file_map().
+ */
+void large_free(void *p, const size_t mapped)
+{
+#if defined(__linux__) && defined(MAP_ANONYMOUS)
+	if (mapped) {
+		munmap(p, mapped);
+		return;
+	}
+#else
+	(void) mapped;
+#endif
+	free(p);
+}
+
 /**
  * @brief Pseudo-random number generator.
  *
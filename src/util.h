@@ -27,6 +27,7 @@ struct Line;
 extern long long (*time_clock)(void);
 long long real_clock(void);
 long long cpu_clock(void);
+long long nano_clock(void);
 void time_print(long long, bool, FILE*);
 long long time_read(FILE*);
 void time_stamp(FILE*);
@@ -179,6 +180,9 @@ typedef OSSpinLock SpinLock;
 /** @macro unlock a spinlock with a macro for genericity */
 #define spin_unlock(c) OSSpinLockUnlock(&(c)->spin)
 
+/** @macro Try to lock a spinlock with a macro for genericity (true if locked) */
+#define spin_trylock(c) OSSpinLockTry(&(c)->spin)
+
 /** @macro Initialize a spinlock with a macro for genericity. */
 #define spin_init(c)  do {(c)->spin = OS_SPINLOCK_INIT;} while (0)
 
@@ -197,6 +201,9 @@ typedef pthread_spinlock_t SpinLock;
 /** @macro unlock a spinlock with a macro for genericity */
 #define spin_unlock(c) pthread_spin_unlock(&(c)->spin)
 
+/** @macro Try to lock a spinlock with a macro for genericity (true if locked) */
+#define spin_trylock(c) (pthread_spin_trylock(&(c)->spin) == 0)
+
 /** @macro Initialize a spinlock with a macro for genericity. */
 #define spin_init(c) pthread_spin_init(&(c)->spin, PTHREAD_PROCESS_PRIVATE)
 
@@ -214,6 +221,9 @@ typedef pthread_mutex_t SpinLock;
 /** @macro unlock a mutex with a macro for genericity */
 #define spin_unlock(c) pthread_mutex_unlock(&(c)->spin)
 
+/** @macro Try to lock a mutex with a macro for genericity (true if locked) */
+#define spin_trylock(c) (pthread_mutex_trylock(&(c)->spin) == 0)
+
 /** @macro Initialize a mutex with a macro for genericity. */
 #define spin_init(c) pthread_mutex_init(&(c)->spin, NULL)
 
@@ -307,6 +317,9 @@ typedef CONDITION_VARIABLE Condition;
 /** @macro unlock a mutex with a macro for genericity */
 #define spin_unlock(c) LeaveCriticalSection(&(c)->spin)
 
+/** @macro Try to lock a mutex with a macro for genericity (true if locked) */
+#define spin_trylock(c) TryEnterCriticalSection(&(c)->spin)
+
 /** @macro Initialize a mutex with a macro for genericity. */
 #define spin_init(c) InitializeCriticalSection(&(c)->spin)
 
@@ -319,6 +332,8 @@ typedef CONDITION_VARIABLE Condition;
 void thread_create(Thread*, void* (*f)(void*), void*);
 void thread_join(Thread);
 void thread_set_cpu(Thread, int);
+void thread_unset_cpu(Thread);
+void thread_yield(void);
 Thread thread_self(void);
 
 /** atomic addition */
@@ -333,9 +348,78 @@ static inline void atomic_add(volatile unsigned long long *value, long long i)
 #endif
 }
 
+/** atomic addition to an int, returning its previous value (full memory barrier) */
+static inline int atomic_add_int(volatile int *value, int i)
+{
+#if defined(_MSC_VER)
+	return InterlockedExchangeAdd((volatile LONG *) value, i);
+#else
+	return __sync_fetch_and_add(value, i);
+#endif
+}
+
+/** full memory barrier */
+static inline void memory_barrier(void)
+{
+#if defined(_MSC_VER)
+	MemoryBarrier();
+#else
+	__sync_synchronize();
+#endif
+}
+
+/** hint the processor that the thread is spinning */
+static inline void cpu_pause(void)
+{
+#if defined(_MSC_VER)
+	YieldProcessor();
+#elif defined(__i386__) || defined(__x86_64__)
+	__asm__ __volatile__("pause");
+#elif defined(__aarch64__) || (defined(__ARM_ARCH) && __ARM_ARCH >= 7)
+	__asm__ __volatile__("yield");
+#endif
+}
+
+/**
+ * An EventCount lets a thread wait for a change without holding a lock.
+ * The waiter takes a key, checks its wake-up condition, and then waits until
+ * the event count has been signalled since the key was taken.
+ */
+typedef struct EventCount {
+	volatile int seq;            /**< signal counter */
+	volatile int n_sleeper;      /**< number of sleeping threads */
+#if !defined(__linux__)
+	Lock lock;                   /**< lock (without futex) */
+	Condition cond;              /**< condition (without futex) */
+#endif
+} EventCount;
+
+/** key of an event count, to take before checking the wake-up condition */
+static inline int eventcount_key(const EventCount *event)
+{
+	memory_barrier();
+	return event->seq;
+}
+
+void eventcount_init(EventCount*);
+void eventcount_free(EventCount*);
+bool eventcount_wait(EventCount*, const int, int);
+void eventcount_signal(EventCount*);
+
 void cpu(void);
+void cpu_init(void);
 int get_cpu_number(void);
 
+/*
+ * Large memory allocation
+ */
+unsigned long long get_numa_node_mask(void);
+void* large_alloc(const size_t, const bool, const bool, size_t*);
+void* shared_alloc(const char*, const size_t, size_t*, bool*);
+void shared_unlink(const char*);
+void* file_map(const char*, size_t*, size_t*);
+void large_free(void*, const size_t);
+
 /*
  * Error management
  */
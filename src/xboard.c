@@ -59,7 +59,7 @@ static void xboard_observer(Result *result)
 		if (result->book_move) fputc('(', xboard_log->f);
 		line_print(&result->pv, -200, " ", xboard_log->f);
 		if (result->book_move) fputc(')', xboard_log->f);
-		putc('\n', xboard_log->f);
+		fprintf(xboard_log->f, " hashfull %d\n", result->hash_full);
 		fflush(xboard_log->f);
 	}
 	spin_unlock(result);
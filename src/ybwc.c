@@ -15,6 +15,16 @@
  *  - Node describes a position shared between different threads.
  *  - Task describes a search running in parallel within a thread.
  *  - TaskStack is a FIFO providing task available for a new search.
+ *  - SplitDeque holds the split points a task offers to the others.
+ *
+ * Alternatively, with the work stealing engine, a node is not split by its
+ * owner, but published as a split point into the deque of its task. Idle tasks
+ * look through the deques of the other tasks for the oldest split point with
+ * moves left, and join it as a slave. A master waiting for its slaves also
+ * steals split points, but only from its slaves, i.e. within its own subtree.
+ *
+ * With lazy smp, no node is split at all: the idle tasks search the root
+ * independently, and only share the hash tables with the main search.
  *
  * References:
  *
@@ -41,6 +51,52 @@
 
 extern Log search_log[1];
 
+static void task_init_help(Task*, Search*);
+
+/**
+ * @brief Wake up the threads waiting for an event.
+ *
+ * @param event Event count.
+ * @param t_signal Time of the wake-up (statistics).
+ */
+static void ybwc_signal(EventCount *event, volatile long long *t_signal)
+{
+	YBWC_STATS(*t_signal = nano_clock();)
+	(void) t_signal;
+	eventcount_signal(event);
+}
+
+/**
+ * @brief Wait for an event, spinning for a while before going to sleep.
+ *
+ * @param event Event count.
+ * @param key Key taken before checking the wake-up condition.
+ * @param t_signal Time of the wake-up (statistics).
+ */
+static void ybwc_wait(EventCount *event, const int key, volatile long long *t_signal)
+{
+	if (eventcount_wait(event, key, options.idle_spin)) {
+		YBWC_STATS(atomic_add(&statistics.n_wake_sleep, 1);)
+		YBWC_STATS(atomic_add(&statistics.t_wake_sleep, nano_clock() - *t_signal);)
+	} else {
+		YBWC_STATS(atomic_add(&statistics.n_wake_spin, 1);)
+		YBWC_STATS(atomic_add(&statistics.t_wake_spin, nano_clock() - *t_signal);)
+	}
+	(void) t_signal;
+}
+
+/**
+ * @brief Run an idle task.
+ *
+ * @param task The task, with its node & move (or none) already set.
+ */
+static void task_wake(Task *task)
+{
+	memory_barrier();	// the task data are written before it runs
+	task->run = true;
+	ybwc_signal(&task->event, &task->t_signal);
+}
+
 /**
  * @brief Initialize a node
  *
@@ -66,7 +122,8 @@ void node_init(Node* node, Search *search, const int alpha, const int beta, cons
 	assert(alpha < beta);
 
 	lock_init(node);
-	condition_init(node);
+	eventcount_init(&node->event);
+	node->t_signal = 0;
 
 	node->alpha = alpha;
 	node->beta = beta;
@@ -74,6 +131,8 @@ void node_init(Node* node, Search *search, const int alpha, const int beta, cons
 	node->height = search->height;
 	node->move = NULL;
 	node->pv_node = false;
+	node->multipv = false;
+	node->endgame = false;
 	node->bestmove = NOMOVE;
 	node->bestscore = -SCORE_INF;
 	node->n_moves_todo = n_moves;
@@ -85,6 +144,7 @@ void node_init(Node* node, Search *search, const int alpha, const int beta, cons
 	node->is_waiting = false;
 	node->is_helping = false;
 	node->stop_point = false;
+	node->is_published = false;
 }
 
 /**
@@ -95,7 +155,7 @@ void node_init(Node* node, Search *search, const int alpha, const int beta, cons
 void node_free(Node *node)
 {
 	lock_free(node);
-	condition_free(node);
+	eventcount_free(&node->event);
 }
 
 /**
@@ -120,10 +180,11 @@ static bool get_helper(Node *master, Node *node, Move *move)
 			if (master->n_slave && master->is_waiting && !master->is_helping) {
 				master->is_helping = true;
 				task = &master->help;
-				task_init(task) ;
+				task_init_help(task, master->search);
 				task->is_helping = true;
 				task->node = node;
 				task->move = move;
+				task->search->end_cache = master->search->end_cache;	// run by the waiting master thread
 				search_clone(task->search, node->search);
 				lock(node);
 					node->slave[node->n_slave++] = task->search;
@@ -131,7 +192,7 @@ static bool get_helper(Node *master, Node *node, Move *move)
 				task->run = true;
 				found = true;
 
-				condition_broadcast(master);
+				ybwc_signal(&master->event, &master->t_signal);
 			}
 			unlock(master);
 		} else {
@@ -142,6 +203,258 @@ static bool get_helper(Node *master, Node *node, Move *move)
 	return found;
 }
 
+/**
+ * @brief Get the next move of the move list.
+ *
+ * This is a thread/safe getter of the next move. If the search is stopped,
+ * or an alphabeta cut has been found or no move is available the function
+ * returns NULL.
+ *
+ * @param node Node data.
+ * @return the next move of the list or NULL if none is available.
+ */
+static Move* node_next_move_lockless(Node *node)
+{
+	Move *move;
+	if (node->move && node->alpha < node->beta && !node->search->stop) {
+		++node->n_moves_done; --node->n_moves_todo;
+		move = node->move = move_next(node->move);
+	} else {
+		move = NULL;
+	}
+
+	return move;
+}
+
+/**
+ * @brief Initialize a split deque.
+ *
+ * @param deque Split deque.
+ */
+static void split_deque_init(SplitDeque *deque)
+{
+	int i;
+
+	deque->n = 0;
+	for (i = 0; i < SPLIT_DEQUE_SIZE; ++i) deque->n_thief[i] = 0;
+}
+
+/**
+ * @brief Check if a node has moves to give to a new slave.
+ *
+ * Same conditions as node_split(), which is called once the move to give has
+ * been taken, while the moves left are checked here before taking it.
+ *
+ * @param node Node.
+ * @return true if the node can be split.
+ */
+static inline bool node_is_splittable(const Node *node)
+{
+	return node->move
+		&& node->alpha < node->beta
+		&& !node->search->stop
+		&& node->n_slave < SPLIT_MAX_SLAVES
+		&& node->n_moves_todo - 1 >= SPLIT_MIN_MOVES_TODO;	// moves left once the stolen move is taken
+}
+
+/**
+ * @brief Check if a node is a descendant of another node.
+ *
+ * @param node Node.
+ * @param ancestor Ancestor node.
+ * @return true if the node is within the subtree of the ancestor.
+ */
+static bool node_is_descendant(const Node *node, const Node *ancestor)
+{
+	for (; node; node = node->parent) {
+		if (node == ancestor) return true;
+	}
+	return false;
+}
+
+/**
+ * @brief Publish a node as a split point (work stealing).
+ *
+ * The node is pushed onto the split deque of its task, with a copy of the
+ * position, so that a thief can set up its search from it while the owner
+ * goes on deeper in the tree. Only the owner writes into its deque, so no lock
+ * is needed. An idle task, if any, is woken up to steal it.
+ *
+ * @param node Node to publish.
+ */
+static void node_publish(Node *node)
+{
+	Search *search = node->search;
+	SplitDeque *deque = &search->task->deque;
+	Task *task;
+
+	if (deque->n < SPLIT_DEQUE_SIZE) {
+		node->board = search->board;
+		node->selectivity = search->selectivity;
+		node->probcut_level = search->probcut_level;
+		node->node_type = search->node_type[search->height];
+		deque->node[deque->n] = node;
+		memory_barrier();	// publish a fully written node
+		++deque->n;
+		node->is_published = true;
+		YBWC_STATS(atomic_add(&statistics.n_split_try, 1);)
+
+		if (search->tasks->n_idle && (task = task_stack_get_idle_task(search->tasks)) != NULL) {
+			task->node = NULL; // nothing given: steal
+			task_wake(task);
+		}
+	}
+}
+
+/**
+ * @brief Withdraw a published node (work stealing).
+ *
+ * The node is popped from the deque. As a thief may still be looking at it,
+ * the owner waits for the thieves of its slot to leave before going on; the
+ * thieves looking at the other split points of the deque do not hold it.
+ *
+ * @param node Node to withdraw.
+ */
+static void node_unpublish(Node *node)
+{
+	SplitDeque *deque = &node->search->task->deque;
+	const int i = deque->n - 1;
+
+	assert(i >= 0 && deque->node[i] == node);
+	deque->n = i;
+	memory_barrier();	// new thieves cannot see the node anymore...
+	while (deque->n_thief[i]) thread_yield();	// ... wait for the older ones
+	node->is_published = false;
+}
+
+/**
+ * @brief Steal a move from a split deque (work stealing).
+ *
+ * The split points are looked at from the oldest one, which is the nearest
+ * from the root and so has the most work left. Once a move is taken, the thief
+ * is a slave of the node, which is kept alive until the slave leaves it.
+ * A thief registers on a slot before checking that it still holds a split
+ * point, so that its owner cannot withdraw the node while it is looked at.
+ *
+ * @param deque Split deque of another task.
+ * @param task Thief task.
+ * @param ancestor If not NULL, steal only within the subtree of this node.
+ * @return true if a move has been stolen, false otherwise.
+ */
+static bool split_deque_steal(SplitDeque *deque, Task *task, const Node *ancestor)
+{
+	Node *node;
+	Move *move = NULL;
+	int i;
+
+	for (i = 0; i < deque->n && move == NULL; ++i) {
+		atomic_add_int(&deque->n_thief[i], 1);	// (with a full barrier)
+		if (i < deque->n) {
+			node = deque->node[i];
+			if (node_is_splittable(node) && (ancestor == NULL || node_is_descendant(node, ancestor))) {
+				lock(node);
+				if (node_is_splittable(node) && (move = node_next_move_lockless(node)) != NULL) {
+					node->slave[node->n_slave++] = task->search;
+					task->node = node;
+					task->move = move;
+				}
+				unlock(node);
+			}
+		}
+		atomic_add_int(&deque->n_thief[i], -1);
+	}
+
+	return move != NULL;
+}
+
+/**
+ * @brief Set up the search of a stolen split point.
+ *
+ * As the owner of the node is searching deeper in the tree, its search is not
+ * copied: the position is rebuilt from the copy made when the node was
+ * published.
+ *
+ * @param task Thief task.
+ */
+static void task_clone_split(Task *task)
+{
+	Node *node = task->node;
+	Search *search = task->search;
+
+	search_attach(search, node->search);
+	search->board = node->board;
+	search_setup(search);
+	search->height = node->height;
+	search->node_type[search->height] = node->node_type;
+	search->selectivity = node->selectivity;
+	search->probcut_level = node->probcut_level;
+}
+
+/**
+ * @brief Help the slaves of a node while waiting for them (work stealing).
+ *
+ * The waiting master steals a split point published by one of its slaves, and
+ * searches it with the helper task of the node. The helper shares the master's
+ * thread, and so its endgame cache and its split deque.
+ * The node is locked when calling and returning from this function.
+ *
+ * @param node Node.
+ * @return true if the master has helped, false otherwise.
+ */
+static bool node_help_slaves(Node *node)
+{
+	SplitDeque *deque[SPLIT_MAX_SLAVES];
+	Task *task = &node->help;
+	int i, n;
+	bool found = false;
+
+	if (node->alpha >= node->beta || node->search->stop) return false;
+	for (i = n = 0; i < node->n_slave; ++i) {
+		if (node->slave[i]->task->deque.n) deque[n++] = &node->slave[i]->task->deque;
+	}
+	if (n == 0) return false;
+	unlock(node);
+
+	task_init_help(task, node->search);
+	task->is_helping = true;
+	task->search->end_cache = node->search->end_cache;
+	task->search->task = node->search->task;
+	for (i = 0; i < n && !found; ++i) {
+		found = split_deque_steal(deque[i], task, node);
+	}
+	if (found) {
+		YBWC_STATS(atomic_add(&statistics.n_master_helper, 1);)
+		task_clone_split(task);
+		task->run = true;
+		task_search(task);
+	}
+	task->search->end_cache = NULL;	// borrowed
+
+	lock(node);
+	return found;
+}
+
+/**
+ * @brief Check if a new split point would find a thread to help its master.
+ *
+ * That is an idle task or, with YBWC, a master waiting at an ancestor node
+ * (see get_helper()). The check is done without lock: it is only a hint.
+ *
+ * @param parent Parent node of the split point.
+ * @param search Search of the split point.
+ * @return true if a helper may be available.
+ */
+bool node_has_helper(const Node *parent, const Search *search)
+{
+	if (search->tasks->n_idle) return true;
+	if (search->options.parallel_mode == PARALLEL_YBWC) {
+		for (; parent; parent = parent->parent) {
+			if (parent->is_waiting && !parent->is_helping) return true;
+		}
+	}
+	return false;
+}
+
 /**
  * @brief Node split.
  *
@@ -160,6 +473,10 @@ static bool get_helper(Node *master, Node *node, Move *move)
  * parent node; then, if none is available, from the idle task stack storage. If no idle task
  * is found, the node splitting fails.
  *
+ * With the work stealing engine, the node is only published once its first move
+ * has been searched, and the splitting always fails here: its moves are taken
+ * by the idle tasks themselves.
+ *
  * @param node Master node to split.
  * @param move move to search.
  * @return true if the split was a success, false otherwise.
@@ -169,6 +486,13 @@ bool node_split(Node *node, Move *move)
 	Task *task;
 	Search *search = node->search;
 
+	if (search->options.parallel_mode != PARALLEL_YBWC) {
+		if (search->options.parallel_mode == PARALLEL_STEAL && !node->is_published
+		 && search->allow_node_splitting && node->depth >= SPLIT_MIN_DEPTH && node->n_moves_done)
+			node_publish(node);
+		return false;
+	}
+
 	if (search->allow_node_splitting // split only if parallelism is on
 	 && node->depth >= SPLIT_MIN_DEPTH // split if we are deep enough
 	 && node->n_moves_done // do not split first move (ybwc main principle).
@@ -188,10 +512,7 @@ bool node_split(Node *node, Move *move)
 			unlock(node);
 			YBWC_STATS(atomic_add(&statistics.n_split_success, 1);)
 
-			lock(task);
-				task->run = true;
-				condition_signal(task);
-			unlock(task);
+			task_wake(task);
 
 			return true;
 		}
@@ -204,14 +525,16 @@ bool node_split(Node *node, Move *move)
  *
  * Actually, three steps are performed here:
  *   -# Stop slaves node in case their scores are unneeded.
- *   -# Wait for slaves' termination.
+ *   -# Wait for slaves' termination (helping them with the work stealing engine).
  *   -# Wake-up the master thread that may have been stopped.
  *
  * @param node Node.
  */
 void node_wait_slaves(Node* node)
 {
-	int i;
+	int i, key;
+
+	if (node->is_published) node_unpublish(node);
 
 	lock(node);
 	// stop slaves ?
@@ -225,25 +548,36 @@ void node_wait_slaves(Node* node)
 	// wait slaves
 	YBWC_STATS(atomic_add(&statistics.n_waited_slave, node->n_slave > 0);)
 	while (node->n_slave) {
+		if (node->search->options.parallel_mode == PARALLEL_STEAL) {
+			if (node_help_slaves(node)) continue;
+			if (node->n_slave == 0) break;
+		}
 		node->is_waiting = true;
 		assert(node->is_helping == false);
-		condition_wait(node);
+		key = eventcount_key(&node->event);
+		unlock(node);
+			ybwc_wait(&node->event, key, &node->t_signal);
+		lock(node);
 
 		if (node->is_helping) {
 			assert(node->help.run);
 			task_search(&node->help);
-			task_free(&node->help);
+			node->help.search->end_cache = NULL;	// borrowed
 			node->is_helping = false;
 		} else {
 			node->is_waiting = false;
 		}
 	}
 
-	// wake-up master thread!
-	if (node->search->stop == STOP_PARALLEL_SEARCH && node->stop_point) {
-		node->search->stop = RUNNING;
+	// wake-up master thread! (unless it has been stopped from elsewhere since)
+	if (node->stop_point) {
+		spin_lock(node->search);
+		if (node->search->stop == STOP_PARALLEL_CUTOFF) {
+			node->search->stop = RUNNING;
+			YBWC_STATS(atomic_add(&statistics.n_wake_up, 1);)
+		}
+		spin_unlock(node->search);
 		node->stop_point = false;
-		YBWC_STATS(atomic_add(&statistics.n_wake_up, 1);)
 	}
 	unlock(node);
 }
@@ -314,42 +648,46 @@ Move* node_first_move(Node *node, MoveList *movelist)
 /**
  * @brief Get the next move of the move list.
  *
- * This is a thread/safe getter of the next move. If the search is stopped,
- * or an alphabeta cut has been found or no move is available the function
- * returns NULL.
+ * This is a thread/safe getter of the next move.
  *
  * @param node Node data.
- * @return the next move of the list or NULL if none is available.
+ * @return the next move of the list.
  */
-static Move* node_next_move_lockless(Node *node)
+Move* node_next_move(Node *node)
 {
 	Move *move;
-	if (node->move && node->alpha < node->beta && !node->search->stop) {
-		++node->n_moves_done; --node->n_moves_todo;
-		move = node->move = move_next(node->move);
-	} else {
-		move = NULL;
-	}
+	lock(node);
+		move = node_next_move_lockless(node);
+	unlock(node);
 
 	return move;
 }
 
 /**
- * @brief Get the next move of the move list.
+ * @brief Detach the search of a task from its parent.
  *
- * This is a thread/safe getter of the next move.
+ * The search is removed from the children of its parent, which takes over
+ * its node count and its hash table replacements.
  *
- * @param node Node data.
- * @return the next move of the list.
+ * @param task The task.
  */
-Move* node_next_move(Node *node)
+static void task_detach(Task *task)
 {
-	Move *move;
-	lock(node);
-		move = node_next_move_lockless(node);
-	unlock(node);
+	Search *search = task->search;
+	int i;
 
-	return move;
+	spin_lock(search->parent);
+		for (i = 0; i < search->parent->n_child; ++i) {
+			if (search->parent->child[i] == search) {
+				--search->parent->n_child;
+				search->parent->child[i] = search->parent->child[search->parent->n_child];
+				break;
+			}
+		}
+		search->parent->child_nodes += search_count_nodes(search);
+		search_count_hash(search, search->parent->child_hash_count);
+		YBWC_STATS(task->n_nodes += search->n_nodes;)
+	spin_unlock(search->parent);
 }
 
 /**
@@ -369,28 +707,36 @@ void task_search(Task *task)
 	Board board0;
 	int i;
 
-	search_set_state(search, node->search->stop);
+	// a cutoff at a deeper split point of the master does not concern this node
+	search_set_state(search, node->search->stop == STOP_PARALLEL_CUTOFF ? RUNNING : node->search->stop);
 
 	YBWC_STATS(++task->n_calls;)
 
 	while (move && !search->stop) {
-		const int alpha = node->alpha;
+		const int alpha = node->multipv ? SCORE_MIN : node->alpha;
 		if (alpha >= node->beta) break;
 
-		board0 = search->board;
-		eval0 = search->eval;
-		search_update_midgame(search, move);
-			move->score = -NWS_midgame(search, -alpha - 1, node->depth - 1, node);
-			if (alpha < move->score && move->score < node->beta) {
-				move->score = -PVS_midgame(search, -node->beta, -alpha, node->depth - 1, node);
-				assert(node->pv_node == true);
-			}
-		search_restore_midgame(search, move->x, &eval0);
-		search->board = board0;
+		if (node->endgame) {
+			search_update_endgame(search, move);
+				move->score = -NWS_endgame(search, -alpha - 1, node);
+			search_restore_endgame(search, move);
+		} else {
+			board0 = search->board;
+			eval0 = search->eval;
+			search_update_midgame(search, move);
+				move->score = -NWS_midgame(search, -alpha - 1, node->depth - 1, node);
+				if (alpha < move->score && move->score < node->beta) {
+					move->score = -PVS_midgame(search, -node->beta, -alpha, node->depth - 1, node);
+					assert(node->pv_node == true);
+				}
+			search_restore_midgame(search, move->x, &eval0);
+			search->board = board0;
+		}
 		if (node->height == 0) {
 			move->cost = search_get_pv_cost(search);
 			move->score = search_bound(search, move->score);
 			if (log_is_open(search_log)) show_current_move(search_log->f, search, move, alpha, node->beta, true);
+			record_root_move(search, move, alpha, node->beta, node->depth);
 		}
 
 		lock(node);
@@ -404,10 +750,14 @@ void task_search(Task *task)
 			}
 			if (node->bestscore > node->alpha) {
 				node->alpha = node->bestscore;
-				if (node->alpha >= node->beta && node->search->stop == RUNNING) { // stop the master thread?
-					node->stop_point = true;
-					node->search->stop = STOP_PARALLEL_SEARCH;
-					YBWC_STATS(atomic_add(&statistics.n_stopped_master, 1);)
+				if (node->alpha >= node->beta) { // stop the master thread?
+					spin_lock(node->search);
+					if (node->search->stop == RUNNING) {
+						node->stop_point = true;
+						node->search->stop = STOP_PARALLEL_CUTOFF;
+						YBWC_STATS(atomic_add(&statistics.n_stopped_master, 1);)
+					}
+					spin_unlock(node->search);
 				}
 			}
 		}
@@ -416,18 +766,7 @@ void task_search(Task *task)
 	}
 
 	search_set_state(search, STOP_END);
-
-	spin_lock(search->parent);
-		for (i = 0; i < search->parent->n_child; ++i) {
-			if (search->parent->child[i] == search) {
-				--search->parent->n_child;
-				search->parent->child[i] = search->parent->child[search->parent->n_child];
-				break;
-			}
-		}
-		search->parent->child_nodes += search_count_nodes(search);
-		YBWC_STATS(task->n_nodes += search->n_nodes;)
-	spin_unlock(search->parent);
+	task_detach(task);
 
 	lock(node);
 		task->run = false;
@@ -438,11 +777,134 @@ void task_search(Task *task)
 				break;
 			}
 		}
-		condition_broadcast(node);
+		ybwc_signal(&node->event, &node->t_signal);
 	unlock(node);
 }
 
 
+/**
+ * @brief Steal split points from the other tasks (work stealing).
+ *
+ * The deques of the other tasks are looked through in turn, and each stolen
+ * split point is searched, until none has been found for a while.
+ *
+ * @param task The thief task.
+ */
+static void task_steal(Task *task)
+{
+	TaskStack *stack = task->container;
+	const int self = task - stack->task;
+	SplitDeque *deque;
+	int i, n_try;
+
+	for (n_try = 0; n_try < SPLIT_STEAL_TRY && task->loop; ++n_try) {
+		for (i = 1; i < stack->n; ++i) {
+			deque = &stack->task[(self + i) % stack->n].deque;
+			if (deque->n && split_deque_steal(deque, task, NULL)) {
+				YBWC_STATS(atomic_add(&statistics.n_split_success, 1);)
+				task_clone_split(task);
+				task->run = true;
+				task_search(task);
+				n_try = -1;
+				break;
+			}
+		}
+		if (n_try >= 0) thread_yield();
+	}
+	task->run = false;
+}
+
+/**
+ * @brief Search the root as a lazy smp helper.
+ *
+ * @param task The helper task.
+ */
+static void task_lazy_search(Task *task)
+{
+	Search *search = task->search;
+	Search *master = search->parent;
+
+	YBWC_STATS(++task->n_calls;)
+
+	search_run_helper(search);
+	search->helper = 0;
+	search_set_state(search, STOP_END);
+	task_detach(task);
+	eventcount_signal(&master->helper_event);	// see lazy_smp_stop()
+	task->run = false;
+}
+
+/**
+ * @brief Start the lazy smp helpers of a search.
+ *
+ * Every idle task gets a clone of the root of the main search, with its own
+ * result, and searches it independently. The helpers only share the hash
+ * tables with the main search, where their results help it to go faster.
+ * To diversify their work, odd helpers start one iteration deeper, and each
+ * helper puts a different move second in its root move ordering.
+ *
+ * @param master The main search.
+ */
+void lazy_smp_start(Search *master)
+{
+	Task *task;
+	Search *helper;
+	Move *move;
+	unsigned long long moves;
+	int k, x;
+
+	for (k = 1; (task = task_stack_get_idle_task(master->tasks)) != NULL; ++k) {
+		helper = task->search;
+		search_clone(helper, master);
+		if (task->result == NULL) {
+			task->result = (Result*) malloc(sizeof (Result));
+			if (task->result == NULL) fatal_error("lazy_smp_start: cannot allocate a result.\n");
+			spin_init(task->result);
+		}
+		helper->result = task->result;
+		helper->helper = k;
+		helper->id = master->id;
+		helper->options.verbosity = 0;
+		helper->allow_node_splitting = false;
+
+		// same root moves as the master's (some may have been excluded)
+		moves = 0;
+		foreach_move(move, master->movelist) moves |= x_to_bit(move->x);
+		search_get_movelist(helper, &helper->movelist);
+		moves = get_moves(helper->board.player, helper->board.opponent) & ~moves;
+		foreach_bit(x, moves) movelist_exclude(&helper->movelist, x);
+
+		spin_lock(master); // do not miss a concurrent stop of the master
+			helper->stop = master->stop;
+		spin_unlock(master);
+		task->node = NULL;
+		task_wake(task);
+	}
+}
+
+/**
+ * @brief Stop the lazy smp helpers of a search, and wait for them.
+ *
+ * The main search sleeps until the last helper has ended, each ending helper
+ * signalling its helper event.
+ *
+ * @param master The main search.
+ */
+void lazy_smp_stop(Search *master)
+{
+	int i, key;
+
+	spin_lock(master);
+		for (i = 0; i < master->n_child; ++i) search_stop_all(master->child[i], STOP_END);
+	spin_unlock(master);
+
+	for (;;) {
+		key = eventcount_key(&master->helper_event);
+		if (master->n_child == 0) break;
+		eventcount_wait(&master->helper_event, key, options.idle_spin);
+	}
+}
+
 /**
  * @brief The main loop runned by a task.
  *
@@ -450,7 +912,11 @@ void task_search(Task *task)
  * In order to diminish the parallelism overhead, we do not launch a new
  * thread at each new splitted node. Instead the threads are created at the
  * beginning of the program and run a waiting loop who enters/quits a
- * parallel search when requested.
+ * parallel search when requested. With the work stealing engine, a task woken
+ * up without a node to search looks for one by itself, while with lazy smp, it
+ * searches the root independently.
+ * An idle task spins for a while before going to sleep, as it is usually woken
+ * up again soon (see options.idle_spin).
  *
  * @param param The task.
  * @return NULL.
@@ -458,22 +924,23 @@ void task_search(Task *task)
 void* task_loop(void *param)
 {
 	Task *task = (Task*) param;
+	int key;
 
-	lock(task);
-	task->loop = true;
-
-	while (task->loop) {
-		if (!task->run) {
-			condition_wait(task);
-		}
+	for (;;) {
+		key = eventcount_key(&task->event);
 		if (task->run) {
-			task_search(task);
+			memory_barrier();	// see the task data written before it runs
+			if (task->node) task_search(task);
+			else if (task->search->helper) task_lazy_search(task);
+			else task_steal(task);
 			task_stack_put_idle_task(task->container, task);
+		} else if (task->loop) {
+			ybwc_wait(&task->event, key, &task->t_signal);
+		} else {
+			break;
 		}
 	}
 
-	unlock(task);
-
 	return NULL;
 }
 
@@ -493,11 +960,16 @@ static Search* task_search_create(Task *task)
 	}
 	search->n_nodes = 0;
 	search->n_child = 0;
+	search->child = NULL;
+	search->n_child_max = 0;
+	search->help_search = NULL;
 	search->parent = NULL;
 	// eval_init(search->eval);
 	spin_init(search);
 	search->task = task;
 	search->stop = STOP_END;
+	search->end_cache = NULL;
+	search->helper = 0;
 
 	return search;
 }
@@ -507,9 +979,12 @@ static Search* task_search_create(Task *task)
  *
  * @param search The search structure.
  */
-static void task_search_destroy(Search *search)
+void task_search_destroy(Search *search)
 {
 	// eval_free(search->eval);
+	if (search->help_search) task_search_destroy(search->help_search);
+	endcache_free(search);
+	free(search->child);
 	spin_free(search);
 	mm_free(search);
 }
@@ -524,8 +999,8 @@ static void task_search_destroy(Search *search)
  */
 void task_init(Task *task)
 {
-	lock_init(task);
-	condition_init(task);
+	eventcount_init(&task->event);
+	task->t_signal = 0;
 
 	task->loop = false;
 	task->run = false;
@@ -533,10 +1008,38 @@ void task_init(Task *task)
 	task->move = NULL;
 	task->n_calls = 0;
 	task->n_nodes = 0;
+	task->result = NULL;
+	split_deque_init(&task->deque);
 	task->search = task_search_create(task);
 }
 
 
+/**
+ * @brief Initialize the helper task of a waiting node.
+ *
+ * The helper task runs within the thread of the waiting search. Its search
+ * structure is allocated once, then kept by the waiting search for its next
+ * waiting nodes, as a search waits at a single node at a time. The task has no
+ * thread of its own, so it is never freed by task_free().
+ *
+ * @param task The helper task.
+ * @param owner The search owning the waiting node.
+ */
+static void task_init_help(Task *task, Search *owner)
+{
+	task->loop = false;
+	task->run = false;
+	task->node = NULL;
+	task->move = NULL;
+	task->n_calls = 0;
+	task->n_nodes = 0;
+	task->result = NULL;
+	split_deque_init(&task->deque);
+	if (owner->help_search == NULL) owner->help_search = task_search_create(task);
+	task->search = owner->help_search;
+	task->search->task = task;
+}
+
 /**
  * @brief Free resources used by a task.
  *
@@ -544,16 +1047,20 @@ void task_init(Task *task)
  */
 void task_free(Task *task)
 {
-	assert(task->run == false);
 	if (task->loop) {
 		task->loop = false; // stop the main loop
-		condition_signal(task);
+		ybwc_signal(&task->event, &task->t_signal);
 		thread_join(task->thread);
 	}
-	lock_free(task);
-	condition_free(task);
+	assert(task->run == false);	// a thief may still be looking for work until the loop stops
+	eventcount_free(&task->event);
 	task_search_destroy(task->search); // free other resources
 	task->search = NULL;
+	if (task->result) {
+		spin_free(task->result);
+		free(task->result);
+		task->result = NULL;
+	}
 }
 
 /**
@@ -586,8 +1093,12 @@ void task_stack_init(TaskStack *stack, const int n)
 		for (i = 0; i < stack->n; ++i) {
 			if (i) {
 				task_init(stack->task + i);
+				endcache_init(stack->task[i].search);	// thread-local
+				stack->task[i].loop = true; // set before the thread starts, for task_free() to wait for it
 				thread_create(&stack->task[i].thread, task_loop, stack->task + i);
 				if (options.cpu_affinity) thread_set_cpu(stack->task[i].thread, i); /* CPU 0 to n - 1 */
+			} else {
+				split_deque_init(&stack->task[i].deque);	// task of the main search
 			}
 			stack->task[i].container = stack;
 			stack->stack[i] = NULL;
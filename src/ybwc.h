@@ -13,6 +13,7 @@
 #define EDAX_YBWC_H
 
 #include "util.h"
+#include "bit.h"
 #include "const.h"
 #include "settings.h"
 
@@ -23,6 +24,17 @@ struct Move;
 struct MoveList;
 struct Task;
 
+/**
+ * A SplitDeque holds the split points published by a task, in work stealing
+ * mode. Only its owner pushes or pops them, at the bottom; other tasks look
+ * for moves to search from the top (the oldest split point).
+ */
+typedef struct SplitDeque {
+	struct Node *volatile node[SPLIT_DEQUE_SIZE]; /**< split points, oldest first */
+	volatile int n;              /**< number of split points */
+	volatile int n_thief[SPLIT_DEQUE_SIZE]; /**< number of tasks looking at each split point */
+} SplitDeque;
+
 /**
  * A Task is a parallel search thread.
  */
@@ -36,9 +48,11 @@ typedef struct Task {
 	Thread thread;               /**< thread */
 	unsigned long long n_calls;  /**< call counter */
 	unsigned long long n_nodes;  /**< nodes counter */
-	Lock lock;                   /**< lock */
-	Condition cond;              /**< condition */
+	EventCount event;            /**< wake-up event */
+	volatile long long t_signal; /**< time of the last wake-up (statistics) */
 	struct TaskStack *container; /**< link to its container */
+	SplitDeque deque;            /**< published split points (work stealing) */
+	struct Result *result;       /**< private result (lazy smp) */
 } Task;
 
 /**
@@ -51,6 +65,8 @@ typedef struct Node {
 	volatile int alpha;          /**< alpha lower bound */
 	int beta;                    /**< beta upper bound (is constant after initialisation) */
 	bool pv_node;                /**< pv_node */
+	bool multipv;                /**< multi PV root node: every move is searched with the full window */
+	bool endgame;                /**< endgame node: the slaves only update the board, the empties & the parity */
 	volatile int n_slave;	     /**< number of slaves splitted flag */
 	volatile bool stop_point;    /**< stop point flag */
 	volatile bool is_waiting;	 /**< waiting flag */
@@ -63,14 +79,21 @@ typedef struct Node {
 	volatile int n_moves_done;   /**< search done */
 	volatile int n_moves_todo;   /**< search todo */
 	volatile bool is_helping;	 /**< waiting flag */
+	bool is_published;           /**< published split point flag (work stealing) */
+	Board board;                 /**< position of a published split point */
+	int selectivity;             /**< selectivity of a published split point */
+	int probcut_level;           /**< probcut recursivity level of a published split point */
+	NodeType node_type;          /**< node type of a published split point */
 	Task help;                   /**< helper task */
 	Lock lock;                   /**< mutex */
-	Condition cond;              /**< condition variable */
+	EventCount event;            /**< wake-up event of the waiting master */
+	volatile long long t_signal; /**< time of the last wake-up (statistics) */
 } Node;
 
 /* node function declaration */
 void node_init(Node*, struct Search*, const int, const int, const int, const int, Node*);
 void node_free(Node*);
+bool node_has_helper(const Node*, const struct Search*);
 bool node_split(Node*, struct Move*);
 void node_stop_slaves(Node*);
 void node_wait_slaves(Node*);
@@ -85,6 +108,9 @@ void task_init(Task*);
 void task_free(Task*);
 void task_update(Task*);
 void task_search(Task *task);
+void task_search_destroy(struct Search*);
+void lazy_smp_start(struct Search*);
+void lazy_smp_stop(struct Search*);
 
 /** @struct TaskStack
  *